@@ -9,7 +9,7 @@ enum class TypeCreation
 	Plasticine,
 };
 
-class CartoonFilm : public Film
+class CartoonFilm final : public Film
 {
 private:
 	TypeCreation creation;
@@ -17,10 +17,12 @@ private:
 public:
 	CartoonFilm(const std::string& title, TypeCreation creation);
 	
-	void print() const override;
+	using Film::print;
+	void print(OutputSink& output) const override;
 	TypeCreation getCreation() const;
 
-	bool matchesCondition(const std::string& condition) const override;
+	bool matches(const Condition& condition) const override;
 	std::string getType() const override;
+	FilmType getTypeTag() const override;
 };
 
@@ -0,0 +1,129 @@
+#include "CommandReader.h"
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const size_t READ_CHUNK_SIZE = 1 << 16;
+
+CommandReader::CommandReader(const std::string& filename, bool allowMapping)
+    : mapped(nullptr), mappedSize(0), position(0),
+      file(nullptr), bufferStart(0), bufferEnd(0), endOfFile(false) {
+    if (allowMapping && mapFile(filename)) {
+        return;
+    }
+    file = std::fopen(filename.c_str(), "rb");
+    if (file) {
+        buffer.resize(READ_CHUNK_SIZE);
+    }
+}
+
+CommandReader::~CommandReader() {
+#ifndef _WIN32
+    if (mapped) {
+        munmap(const_cast<char*>(mapped), mappedSize);
+    }
+#endif
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+bool CommandReader::mapFile(const std::string& filename) {
+#ifndef _WIN32
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+    madvise(data, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    mapped = static_cast<const char*>(data);
+    mappedSize = static_cast<size_t>(info.st_size);
+    return true;
+#else
+    (void)filename;
+    return false;
+#endif
+}
+
+bool CommandReader::isOpen() const {
+    return mapped != nullptr || file != nullptr;
+}
+
+bool CommandReader::isMapped() const {
+    return mapped != nullptr;
+}
+
+bool CommandReader::fillBuffer() {
+    if (endOfFile) {
+        return false;
+    }
+    if (bufferStart > 0) {
+        std::memmove(buffer.data(), buffer.data() + bufferStart, bufferEnd - bufferStart);
+        bufferEnd -= bufferStart;
+        bufferStart = 0;
+    }
+    if (buffer.size() - bufferEnd < READ_CHUNK_SIZE) {
+        buffer.resize(buffer.size() * 2);
+    }
+    size_t count = std::fread(buffer.data() + bufferEnd, 1, buffer.size() - bufferEnd, file);
+    if (count == 0) {
+        endOfFile = true;
+        return false;
+    }
+    bufferEnd += count;
+    return true;
+}
+
+bool CommandReader::nextLine(std::string_view& line) {
+    if (mapped) {
+        if (position >= mappedSize) {
+            return false;
+        }
+        const char* begin = mapped + position;
+        const void* newline = std::memchr(begin, '\n', mappedSize - position);
+        size_t length = newline ? static_cast<const char*>(newline) - begin : mappedSize - position;
+        line = std::string_view(begin, length);
+        position += newline ? length + 1 : length;
+        return true;
+    }
+
+    if (!file) {
+        return false;
+    }
+    size_t searchFrom = bufferStart;
+    while (true) {
+        const void* newline = std::memchr(buffer.data() + searchFrom, '\n', bufferEnd - searchFrom);
+        if (newline) {
+            const char* begin = buffer.data() + bufferStart;
+            size_t length = static_cast<const char*>(newline) - begin;
+            line = std::string_view(begin, length);
+            bufferStart += length + 1;
+            return true;
+        }
+        size_t scanned = bufferEnd - bufferStart;
+        if (!fillBuffer()) {
+            break;
+        }
+        searchFrom = bufferStart + scanned;
+    }
+    if (bufferStart < bufferEnd) {
+        line = std::string_view(buffer.data() + bufferStart, bufferEnd - bufferStart);
+        bufferStart = bufferEnd;
+        return true;
+    }
+    return false;
+}
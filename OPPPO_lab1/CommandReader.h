@@ -0,0 +1,35 @@
+#pragma once
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class CommandReader
+{
+private:
+	const char* mapped;
+	size_t mappedSize;
+	size_t position;
+
+	std::FILE* file;
+	std::vector<char> buffer;
+	size_t bufferStart;
+	size_t bufferEnd;
+	bool endOfFile;
+
+	bool mapFile(const std::string& filename);
+	bool fillBuffer();
+
+public:
+	explicit CommandReader(const std::string& filename, bool allowMapping = true);
+	~CommandReader();
+
+	CommandReader(const CommandReader&) = delete;
+	CommandReader& operator=(const CommandReader&) = delete;
+
+	bool isOpen() const;
+	bool isMapped() const;
+
+	// Строка действительна до следующего вызова nextLine
+	bool nextLine(std::string_view& line);
+};
@@ -0,0 +1,584 @@
+#include "Commands.h"
+#include "CommandReader.h"
+#include "FilmIndex.h"
+#include "GameFilm.h"
+#include "CartoonFilm.h"
+#include "SeriesFilm.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <deque>
+#include <fstream>
+#include <optional>
+#include <sstream>
+#include <vector>
+
+static const size_t PARALLEL_ADD_MIN_LINES = 1024;
+static const size_t ADD_BATCH_MAX_LINES = 1 << 16;
+
+static bool isBlank(char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+static void skipWhitespace(std::string_view& text) {
+    size_t start = 0;
+    while (start < text.size() && isBlank(text[start])) {
+        ++start;
+    }
+    text.remove_prefix(start);
+}
+
+static std::string_view nextToken(std::string_view& text) {
+    skipWhitespace(text);
+    size_t length = 0;
+    while (length < text.size() && !isBlank(text[length])) {
+        ++length;
+    }
+    std::string_view token = text.substr(0, length);
+    text.remove_prefix(length);
+    return token;
+}
+
+std::unique_ptr<Film> createFilm(const std::string& type, const std::string& title, const std::string& additionalData)
+{
+    if (type.empty() || title.empty()) {
+        throw std::invalid_argument("Film type and title cannot be empty");
+    }
+
+    std::istringstream iss(additionalData);
+
+    if (type == "game") {
+        std::string director;
+        std::getline(iss, director);
+        if (director.empty()) {
+            throw std::invalid_argument("Director cannot be empty for game film");
+        }
+        return std::make_unique<GameFilm>(title, director);
+    }
+    else if (type == "cartoon") {
+        std::string animType;
+        iss >> animType;
+        if (animType.empty()) {
+            throw std::invalid_argument("Animation type cannot be empty for cartoon film");
+        }
+        TypeCreation typeEnum;
+        if (animType == "drawn") typeEnum = TypeCreation::Drawn;
+        else if (animType == "puppet") typeEnum = TypeCreation::Doll;
+        else if (animType == "plasticine") typeEnum = TypeCreation::Plasticine;
+        else {
+            throw std::invalid_argument("Invalid animation type: '" + animType + "'. Use: drawn, puppet, plasticine");
+        }
+        return std::make_unique<CartoonFilm>(title, typeEnum);
+    }
+    else if (type == "series") {
+        std::string director;
+        int episodes = 0;
+        if (!std::getline(iss, director, '|')) {
+            throw std::invalid_argument("Missing director for series film");
+        }
+        director.erase(0, director.find_first_not_of(" \t"));
+        director.erase(director.find_last_not_of(" \t") + 1);
+        if (director.empty()) {
+            throw std::invalid_argument("Director cannot be empty for series film");
+        }
+        if (!(iss >> episodes)) {
+            throw std::invalid_argument("Missing or invalid episode count for series film");
+        }
+        if (episodes <= 0) {
+            throw std::invalid_argument("Episode count must be positive for series film");
+        }
+        return std::make_unique<SeriesFilm>(title, director, episodes);
+    }
+    else {
+        throw std::invalid_argument("Unknown film type: '" + type + "'. Use: game, cartoon, or series");
+    }
+}
+
+static bool parseEpisodeCount(std::string_view token, int& episodes) {
+    std::string_view digits = token;
+    if (!digits.empty() && digits.front() == '+') {
+        digits.remove_prefix(1);
+        if (digits.empty() || digits.front() == '-') {
+            return false;
+        }
+    }
+    auto result = std::from_chars(digits.data(), digits.data() + digits.size(), episodes);
+    return result.ec == std::errc();
+}
+
+static void trimBlanks(std::string_view& text) {
+    size_t start = text.find_first_not_of(" \t");
+    if (start == std::string_view::npos) {
+        text = std::string_view();
+        return;
+    }
+    text = text.substr(start, text.find_last_not_of(" \t") - start + 1);
+}
+
+bool parseAddCommand(std::string_view arguments, AddRecord& record, std::string& error) {
+    std::string_view type = nextToken(arguments);
+    if (type.empty()) {
+        error = "Error: Missing film type after ADD command";
+        return false;
+    }
+    skipWhitespace(arguments);
+    if (arguments.empty()) {
+        error = "Error: Missing title for ADD command. Format: ADD type title|additional_data";
+        return false;
+    }
+
+    size_t separator = arguments.find('|');
+    record.title = arguments.substr(0, separator);
+    std::string_view additionalData;
+    if (separator != std::string_view::npos) {
+        additionalData = arguments.substr(separator + 1);
+    }
+    if (!record.title.empty() && record.title.front() == '"' && record.title.back() == '"') {
+        record.title = record.title.substr(1, record.title.size() - 2);
+    }
+    additionalData.remove_prefix(std::min(additionalData.size(), additionalData.find_first_not_of(" \t")));
+
+    const char* emptyTitle = "Error creating film: Film type and title cannot be empty";
+    if (type == "cartoon") {
+        std::string_view animType = nextToken(additionalData);
+        if (animType == "drawn") record.creation = TypeCreation::Drawn;
+        else if (animType == "puppet") record.creation = TypeCreation::Doll;
+        else if (animType == "plasticine") record.creation = TypeCreation::Plasticine;
+        else {
+            error = "Error: Invalid animation type. Use: drawn, puppet, or plasticine";
+            return false;
+        }
+        if (record.title.empty()) {
+            error = emptyTitle;
+            return false;
+        }
+        record.type = FilmType::Cartoon;
+    }
+    else if (type == "game") {
+        if (record.title.empty()) {
+            error = emptyTitle;
+            return false;
+        }
+        if (additionalData.empty()) {
+            error = "Error creating film: Director cannot be empty for game film";
+            return false;
+        }
+        record.type = FilmType::Game;
+        record.director = additionalData;
+    }
+    else if (type == "series") {
+        separator = additionalData.find('|');
+        record.director = additionalData.substr(0, separator);
+        std::string_view rest;
+        if (separator != std::string_view::npos) {
+            rest = additionalData.substr(separator + 1);
+        }
+        std::string_view episodesToken = nextToken(rest);
+        if (!parseEpisodeCount(episodesToken, record.episodes)) {
+            error = "Error: Invalid episode count '" + std::string(episodesToken) + "'. Must be a number";
+            return false;
+        }
+        if (record.episodes <= 0) {
+            error = "Error: Episode count must be positive";
+            return false;
+        }
+        if (record.title.empty()) {
+            error = emptyTitle;
+            return false;
+        }
+        trimBlanks(record.director);
+        if (record.director.empty()) {
+            error = "Error creating film: Director cannot be empty for series film";
+            return false;
+        }
+        record.type = FilmType::Series;
+    }
+    else {
+        error = "Error: Unknown film type '" + std::string(type) + "'. Use: cartoon, game, or series";
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<Film> createFilm(const AddRecord& record) {
+    switch (record.type) {
+    case FilmType::Game:
+        return std::make_unique<GameFilm>(std::string(record.title), std::string(record.director));
+    case FilmType::Cartoon:
+        return std::make_unique<CartoonFilm>(std::string(record.title), record.creation);
+    case FilmType::Series:
+        return std::make_unique<SeriesFilm>(std::string(record.title), std::string(record.director), record.episodes);
+    }
+    return nullptr;
+}
+
+FilmValue createFilmValue(const AddRecord& record) {
+    switch (record.type) {
+    case FilmType::Cartoon:
+        return CartoonFilm(std::string(record.title), record.creation);
+    case FilmType::Series:
+        return SeriesFilm(std::string(record.title), std::string(record.director), record.episodes);
+    default:
+        return GameFilm(std::string(record.title), std::string(record.director));
+    }
+}
+
+struct AddResult
+{
+    std::optional<FilmValue> film;
+    std::string error;
+};
+
+static void buildFilm(std::string_view arguments, AddResult& result) {
+    AddRecord record;
+    if (!parseAddCommand(arguments, record, result.error)) {
+        return;
+    }
+
+    try {
+        result.film = createFilmValue(record);
+    }
+    catch (const std::exception& e) {
+        result.error = std::string("Error creating film: ") + e.what();
+    }
+    catch (...) {
+        result.error = "Unknown error occurred while creating film";
+    }
+}
+
+// Вывод не сбрасывается: подряд идущие ADD сбрасываются один раз на границе серии
+static void applyAddCommand(std::string_view arguments, FilmContainer& container) {
+    AddResult result;
+    buildFilm(arguments, result);
+    if (!result.film) {
+        container.getOutput() << result.error << '\n';
+        return;
+    }
+    container.addFilm(std::move(*result.film));
+}
+
+void processAddCommand(std::string_view arguments, FilmContainer& container) {
+    applyAddCommand(arguments, container);
+    container.getOutput().flush();
+}
+
+void processRemoveCommand(std::string_view arguments, FilmContainer& container) {
+    skipWhitespace(arguments);
+    if (arguments.empty()) {
+        OutputSink& output = container.getOutput();
+        output << "Error: Missing condition for REM command\n";
+        output.flush();
+        return;
+    }
+    container.removeFilms(std::string(arguments));
+}
+
+// Запись журнала DEL n: удаление по id, воспроизводимое через номер записи ADD
+static void processDeleteRecord(std::string_view arguments, FilmContainer& container) {
+    std::string_view token = nextToken(arguments);
+    uint64_t ordinal = 0;
+    auto parsed = std::from_chars(token.data(), token.data() + token.size(), ordinal);
+    if (token.empty() || parsed.ec != std::errc() || parsed.ptr != token.data() + token.size()) {
+        OutputSink& output = container.getOutput();
+        output << "Error: Invalid DEL record '" << token << "'\n";
+        output.flush();
+        return;
+    }
+    container.removeJournaled(ordinal);
+}
+
+void processPrintCommand(std::string_view arguments, FilmContainer& container) {
+    std::string_view option = nextToken(arguments);
+    if (option.empty()) {
+        container.printAll();
+    }
+    else if (option == "ids") {
+        container.printAll(true);
+    }
+    else {
+        OutputSink& output = container.getOutput();
+        output << "Error: Unknown PRINT option '" << option << "'\n";
+        output.flush();
+    }
+}
+
+// Отделяет необязательный LIMIT n в конце условия; false, если n не положительное число
+static bool takeLimit(std::string_view& arguments, size_t& limit) {
+    trimBlanks(arguments);
+    size_t split = arguments.find_last_of(" \t");
+    if (split == std::string_view::npos) {
+        return true;
+    }
+    std::string_view condition = arguments.substr(0, split);
+    trimBlanks(condition);
+    const std::string_view keyword = "LIMIT";
+    if (condition.size() < keyword.size() || condition.substr(condition.size() - keyword.size()) != keyword
+        || (condition.size() > keyword.size() && !isBlank(condition[condition.size() - keyword.size() - 1]))) {
+        return true;
+    }
+    std::string_view digits = arguments.substr(split + 1);
+    auto result = std::from_chars(digits.data(), digits.data() + digits.size(), limit);
+    if (result.ec != std::errc() || result.ptr != digits.data() + digits.size() || limit == 0) {
+        return false;
+    }
+    condition.remove_suffix(keyword.size());
+    trimBlanks(condition);
+    arguments = condition;
+    return true;
+}
+
+void processFindCommand(std::string_view arguments, FilmContainer& container) {
+    OutputSink& output = container.getOutput();
+    size_t limit = SIZE_MAX;
+    if (!takeLimit(arguments, limit)) {
+        output << "Error: LIMIT must be a positive number\n";
+        output.flush();
+        return;
+    }
+    if (arguments.empty()) {
+        output << "Error: Missing condition for FIND command\n";
+        output.flush();
+        return;
+    }
+    container.findFilms(std::string(arguments), limit);
+}
+
+void processCountCommand(std::string_view arguments, FilmContainer& container) {
+    trimBlanks(arguments);
+    if (arguments.empty()) {
+        OutputSink& output = container.getOutput();
+        output << "Error: Missing condition for COUNT command\n";
+        output.flush();
+        return;
+    }
+    container.countFilms(std::string(arguments));
+}
+
+struct PendingAdd
+{
+    std::string_view arguments;
+    int lineNumber;
+};
+
+static void flushPendingAdds(std::vector<PendingAdd>& pending, std::deque<std::string>& ownedLines,
+    ThreadPool& pool, FilmContainer& container, bool batchAdds) {
+    if (pending.empty()) {
+        return;
+    }
+    OutputSink& output = container.getOutput();
+
+    std::vector<AddResult> results(pending.size());
+    auto build = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            try {
+                buildFilm(pending[i].arguments, results[i]);
+            }
+            catch (const std::exception& e) {
+                results[i].error = "Error processing command at line " + std::to_string(pending[i].lineNumber) + ": " + e.what();
+            }
+            catch (...) {
+                results[i].error = "Unknown error processing command at line " + std::to_string(pending[i].lineNumber);
+            }
+        }
+    };
+    if (pending.size() < PARALLEL_ADD_MIN_LINES) {
+        build(0, pending.size());
+    }
+    else {
+        pool.parallelFor(pending.size(), build);
+    }
+
+    if (batchAdds) {
+        std::vector<FilmValue> batch;
+        batch.reserve(results.size());
+        for (AddResult& result : results) {
+            if (result.film) {
+                batch.push_back(std::move(*result.film));
+            }
+            else {
+                output << result.error << '\n';
+            }
+        }
+        if (!batch.empty()) {
+            container.addFilms(std::move(batch));
+        }
+    }
+    else {
+        for (AddResult& result : results) {
+            if (result.film) {
+                container.addFilm(std::move(*result.film));
+            }
+            else {
+                output << result.error << '\n';
+            }
+        }
+    }
+    pending.clear();
+    ownedLines.clear();
+}
+
+static bool takeFilename(std::string_view arguments, const char* command, FilmContainer& container, std::string& filename) {
+    skipWhitespace(arguments);
+    while (!arguments.empty() && isBlank(arguments.back())) {
+        arguments.remove_suffix(1);
+    }
+    if (arguments.empty()) {
+        OutputSink& output = container.getOutput();
+        output << "Error: Missing filename for " << command << " command\n";
+        output.flush();
+        return false;
+    }
+    filename.assign(arguments);
+    return true;
+}
+
+void processSaveCommand(std::string_view arguments, FilmContainer& container) {
+    std::string filename;
+    if (takeFilename(arguments, "SAVE", container, filename)) {
+        container.saveSnapshot(filename);
+    }
+}
+
+void processLoadCommand(std::string_view arguments, FilmContainer& container) {
+    std::string filename;
+    if (takeFilename(arguments, "LOAD", container, filename)) {
+        container.loadSnapshot(filename);
+    }
+}
+
+void processStatsCommand(FilmContainer& container) {
+    StringPoolStats stats = StringPool::shared().getStats();
+    OutputSink& output = container.getOutput();
+    output << "String pool: " << stats.distinctStrings << " distinct string(s), "
+        << stats.references << " reference(s), " << stats.storedBytes << " byte(s) stored, "
+        << stats.overheadBytes << " byte(s) entry overhead, " << stats.savedBytes() << " byte(s) saved, "
+        << stats.contendedLocks << " of " << stats.lockAcquisitions << " lock(s) contended\n";
+    if (const FilmStatistics* statistics = container.getStatistics()) {
+        output << "Films: " << statistics->getTypeCount(FilmType::Game) << " game(s), "
+            << statistics->getTypeCount(FilmType::Cartoon) << " cartoon(s), "
+            << statistics->getTypeCount(FilmType::Series) << " series, "
+            << statistics->getDistinctDirectors() << " distinct director(s)\n";
+    }
+    output << "Query plans: " << container.getIndexPlanCount() << " index probe(s), "
+        << container.getScanPlanCount() << " scan(s)\n";
+    output.flush();
+}
+
+void processJournalCommand(std::string_view arguments, FilmContainer& container) {
+    std::string filename;
+    if (!takeFilename(arguments, "JOURNAL", container, filename)) {
+        return;
+    }
+
+    container.detachJournal();
+    if (std::ifstream(filename).is_open()) {
+        OutputSink& output = container.getOutput();
+        size_t before = container.size();
+        NullOutputSink silent;
+        container.setOutput(silent);
+        CommandOptions options;
+        options.batchAdds = true;
+        options.journalReplay = true;
+        container.beginJournalReplay();
+        commandFromFile(filename, container, options);
+        container.setOutput(output);
+        output << "Journal replayed: " << container.size() - before << " film(s) from '" << filename << "'\n";
+    }
+    container.attachJournal(filename);
+}
+
+void commandFromFile(const std::string& filename, FilmContainer& container, const CommandOptions& options) {
+    OutputSink& output = container.getOutput();
+    CommandReader reader(filename);
+    if (!reader.isOpen()) {
+        output << "Error: Cannot open file '" << filename << "'\n";
+        output.flush();
+        return;
+    }
+
+    ThreadPool pool(options.threads);
+    std::vector<PendingAdd> pending;
+    // Без отображения в память строки читателя живут только до следующего вызова nextLine
+    std::deque<std::string> ownedLines;
+
+    std::string_view line;
+    int lineNumber = 0;
+    bool addRun = false;
+    while (reader.nextLine(line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::string_view command = nextToken(line);
+        if (command.empty()) {
+            continue;
+        }
+
+        if (command == "ADD" && (pool.size() > 1 || options.batchAdds)) {
+            if (!reader.isMapped()) {
+                line = ownedLines.emplace_back(line);
+            }
+            pending.push_back({ line, lineNumber });
+            addRun = true;
+            if (pending.size() >= ADD_BATCH_MAX_LINES) {
+                flushPendingAdds(pending, ownedLines, pool, container, options.batchAdds);
+            }
+            continue;
+        }
+        flushPendingAdds(pending, ownedLines, pool, container, options.batchAdds);
+        if (command != "ADD" && addRun) {
+            output.flush();
+            addRun = false;
+        }
+
+        try {
+            if (command == "ADD") {
+                applyAddCommand(line, container);
+                addRun = true;
+            }
+            else if (command == "REM") {
+                processRemoveCommand(line, container);
+            }
+            else if (command == "DEL" && options.journalReplay) {
+                processDeleteRecord(line, container);
+            }
+            else if (command == "FIND") {
+                processFindCommand(line, container);
+            }
+            else if (command == "COUNT") {
+                processCountCommand(line, container);
+            }
+            else if (command == "PRINT") {
+                processPrintCommand(line, container);
+            }
+            else if (command == "SAVE") {
+                processSaveCommand(line, container);
+            }
+            else if (command == "LOAD") {
+                processLoadCommand(line, container);
+            }
+            else if (command == "JOURNAL") {
+                processJournalCommand(line, container);
+            }
+            else if (command == "COMPACT") {
+                container.compactJournal();
+            }
+            else if (command == "STATS") {
+                processStatsCommand(container);
+            }
+            else {
+                output << "Error: Unknown command '" << command << "' at line " << lineNumber << '\n';
+            }
+        }
+        catch (const std::exception& e) {
+            output << "Error processing command at line " << lineNumber << ": " << e.what() << '\n';
+        }
+        catch (...) {
+            output << "Unknown error processing command at line " << lineNumber << '\n';
+        }
+    }
+    flushPendingAdds(pending, ownedLines, pool, container, options.batchAdds);
+    output << "Finished processing file. Total films in container: " << container.size() << '\n';
+    output.flush();
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "FilmContainer.h"
+#include "CartoonFilm.h"
+#include "FilmValue.h"
+#include <memory>
+#include <string>
+#include <string_view>
+
+struct AddRecord
+{
+    FilmType type = FilmType::Game;
+    std::string_view title;
+    std::string_view director;
+    TypeCreation creation = TypeCreation::Drawn;
+    int episodes = 0;
+};
+
+std::unique_ptr<Film> createFilm(const std::string& type, const std::string& title, const std::string& additionalData);
+std::unique_ptr<Film> createFilm(const AddRecord& record);
+FilmValue createFilmValue(const AddRecord& record);
+bool parseAddCommand(std::string_view arguments, AddRecord& record, std::string& error);
+void processAddCommand(std::string_view arguments, FilmContainer& container);
+void processRemoveCommand(std::string_view arguments, FilmContainer& container);
+void processPrintCommand(std::string_view arguments, FilmContainer& container);
+void processFindCommand(std::string_view arguments, FilmContainer& container);
+void processCountCommand(std::string_view arguments, FilmContainer& container);
+void processSaveCommand(std::string_view arguments, FilmContainer& container);
+void processLoadCommand(std::string_view arguments, FilmContainer& container);
+void processJournalCommand(std::string_view arguments, FilmContainer& container);
+void processStatsCommand(FilmContainer& container);
+struct CommandOptions
+{
+    // Потоки для разбора серий ADD; 0 - по числу ядер, 1 - строго последовательно
+    unsigned threads = 0;
+    // Подряд идущие ADD добавляются одним addFilms с итоговой строкой вместо строки на фильм
+    bool batchAdds = false;
+    // Воспроизведение журнала: разрешены записи DEL n, удаляющие фильм n-й записи ADD
+    bool journalReplay = false;
+};
+
+void commandFromFile(const std::string& filename, FilmContainer& container, const CommandOptions& options = CommandOptions());
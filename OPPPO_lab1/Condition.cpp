@@ -0,0 +1,165 @@
+#include "Condition.h"
+#include "StringSearch.h"
+#include <sstream>
+#include <stdexcept>
+
+Condition::Condition()
+    : field(ConditionField::Unknown), op(ConditionOp::Unknown), number(0), numberValid(false), id(0), idValid(false),
+      creation(TypeCreation::Drawn), creationValid(false) {}
+
+Condition Condition::compile(const std::string& condition) {
+    Condition result;
+    result.text = condition;
+    if (condition.empty()) {
+        return result;
+    }
+
+    std::istringstream iss(condition);
+    std::string fieldStr, opStr;
+    iss >> fieldStr >> opStr;
+
+    std::getline(iss, result.value);
+
+    result.value.erase(0, result.value.find_first_not_of(" \t"));
+    result.value.erase(result.value.find_last_not_of(" \t") + 1);
+
+    if (fieldStr == "title") result.field = ConditionField::Title;
+    else if (fieldStr == "director") result.field = ConditionField::Director;
+    else if (fieldStr == "animation_type") result.field = ConditionField::AnimationType;
+    else if (fieldStr == "episodes") result.field = ConditionField::Episodes;
+    else if (fieldStr == "type") result.field = ConditionField::Type;
+    else if (fieldStr == "id") result.field = ConditionField::Id;
+
+    if (opStr == "==") result.op = ConditionOp::Equal;
+    else if (opStr == "!=") result.op = ConditionOp::NotEqual;
+    else if (opStr == "contains") result.op = ConditionOp::Contains;
+    else if (opStr == ">") result.op = ConditionOp::Greater;
+    else if (opStr == "<") result.op = ConditionOp::Less;
+    else if (opStr == ">=") result.op = ConditionOp::GreaterEqual;
+    else if (opStr == "<=") result.op = ConditionOp::LessEqual;
+
+    if (result.field == ConditionField::Title || result.field == ConditionField::Director) {
+        result.internedValue = StringPool::shared().find(result.value);
+    }
+    else if (result.field == ConditionField::Episodes) {
+        try {
+            result.number = std::stoi(result.value);
+            result.numberValid = true;
+        }
+        catch (const std::invalid_argument&) {
+        }
+        catch (const std::out_of_range&) {
+        }
+    }
+    else if (result.field == ConditionField::Id) {
+        // Идентификатор только из цифр: stoull молча принял бы знак минус
+        if (!result.value.empty() && result.value.find_first_not_of("0123456789") == std::string::npos) {
+            try {
+                result.id = std::stoull(result.value);
+                result.idValid = true;
+            }
+            catch (const std::out_of_range&) {
+            }
+        }
+    }
+    else if (result.field == ConditionField::AnimationType) {
+        result.creationValid = true;
+        if (result.value == "drawn") result.creation = TypeCreation::Drawn;
+        else if (result.value == "doll") result.creation = TypeCreation::Doll;
+        else if (result.value == "plasticine") result.creation = TypeCreation::Plasticine;
+        else if (result.value == "puppet") result.creation = TypeCreation::Doll;
+        else result.creationValid = false;
+    }
+
+    return result;
+}
+
+const std::string& Condition::getText() const {
+    return text;
+}
+
+ConditionField Condition::getField() const {
+    return field;
+}
+
+ConditionOp Condition::getOp() const {
+    return op;
+}
+
+const std::string& Condition::getValue() const {
+    return value;
+}
+
+bool Condition::hasNumber() const {
+    return numberValid;
+}
+
+int Condition::getNumber() const {
+    return number;
+}
+
+bool Condition::hasId() const {
+    return idValid;
+}
+
+uint64_t Condition::getId() const {
+    return id;
+}
+
+bool Condition::matchesText(std::string_view text) const {
+    switch (op) {
+    case ConditionOp::Equal: return equalBytes(text, value);
+    case ConditionOp::NotEqual: return !equalBytes(text, value);
+    case ConditionOp::Contains: return containsBytes(text, value);
+    default: return false;
+    }
+}
+
+bool Condition::matchesString(const InternedString& text) const {
+    // Значение, которого не было в пуле при компиляции, могло появиться позже - сравниваем байты
+    if (internedValue.empty()) {
+        return matchesText(text);
+    }
+    switch (op) {
+    case ConditionOp::Equal: return text == internedValue;
+    case ConditionOp::NotEqual: return text != internedValue;
+    default: return matchesText(text);
+    }
+}
+
+bool Condition::matchesNumber(int actual) const {
+    if (!numberValid) {
+        return false;
+    }
+    switch (op) {
+    case ConditionOp::Equal: return actual == number;
+    case ConditionOp::NotEqual: return actual != number;
+    case ConditionOp::Greater: return actual > number;
+    case ConditionOp::Less: return actual < number;
+    case ConditionOp::GreaterEqual: return actual >= number;
+    case ConditionOp::LessEqual: return actual <= number;
+    default: return false;
+    }
+}
+
+bool Condition::matchesCreation(TypeCreation actual) const {
+    if (!creationValid) {
+        return false;
+    }
+    if (op == ConditionOp::Equal) return actual == creation;
+    if (op == ConditionOp::NotEqual) return actual != creation;
+    return false;
+}
+
+bool Condition::matchesType(const char* type) const {
+    return op == ConditionOp::Equal && value == type;
+}
+
+bool Condition::matchesId(uint64_t actual) const {
+    if (!idValid) {
+        return false;
+    }
+    if (op == ConditionOp::Equal) return actual == id;
+    if (op == ConditionOp::NotEqual) return actual != id;
+    return false;
+}
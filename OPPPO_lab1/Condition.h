@@ -0,0 +1,67 @@
+#pragma once
+#include "CartoonFilm.h"
+#include "StringPool.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+enum class ConditionField
+{
+	Title,
+	Director,
+	AnimationType,
+	Episodes,
+	Type,
+	Id,
+	Unknown,
+};
+
+enum class ConditionOp
+{
+	Equal,
+	NotEqual,
+	Contains,
+	Greater,
+	Less,
+	GreaterEqual,
+	LessEqual,
+	Unknown,
+};
+
+class Condition
+{
+private:
+	std::string text;
+	ConditionField field;
+	ConditionOp op;
+	std::string value;
+	InternedString internedValue;
+	int number;
+	bool numberValid;
+	uint64_t id;
+	bool idValid;
+	TypeCreation creation;
+	bool creationValid;
+
+	Condition();
+
+public:
+	static Condition compile(const std::string& condition);
+
+	const std::string& getText() const;
+	ConditionField getField() const;
+	ConditionOp getOp() const;
+	const std::string& getValue() const;
+	bool hasNumber() const;
+	int getNumber() const;
+	bool hasId() const;
+	uint64_t getId() const;
+
+	bool matchesText(std::string_view text) const;
+	// Для строк из пула == и != сравнивают ссылки, а не байты
+	bool matchesString(const InternedString& text) const;
+	bool matchesNumber(int actual) const;
+	bool matchesCreation(TypeCreation actual) const;
+	bool matchesType(const char* type) const;
+	bool matchesId(uint64_t actual) const;
+};
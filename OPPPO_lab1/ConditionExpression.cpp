@@ -0,0 +1,329 @@
+#include "ConditionExpression.h"
+#include "Film.h"
+#include <algorithm>
+#include <string_view>
+
+// Рекурсивный спуск: or := and (OR and)*, and := unary (AND unary)*, unary := NOT unary | ( or ) | условие
+class ConditionExpression::Parser
+{
+private:
+    std::string_view text;
+    size_t position = 0;
+    int depth = 0;
+    bool compound = false;
+    ConditionExpression& expression;
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t';
+    }
+
+    void skipSpaces() {
+        while (position < text.size() && isSpace(text[position])) {
+            ++position;
+        }
+    }
+
+    // Ключевое слово целиком: за ним пробел, скобка или конец строки
+    bool atKeyword(std::string_view keyword) const {
+        if (text.compare(position, keyword.size(), keyword) != 0) {
+            return false;
+        }
+        size_t end = position + keyword.size();
+        return end == text.size() || isSpace(text[end]) || text[end] == '(';
+    }
+
+    bool takeKeyword(std::string_view keyword) {
+        if (!atKeyword(keyword)) {
+            return false;
+        }
+        position += keyword.size();
+        compound = true;
+        return true;
+    }
+
+    std::string_view takeWord() {
+        size_t start = position;
+        while (position < text.size() && !isSpace(text[position]) && text[position] != '(' && text[position] != ')') {
+            ++position;
+        }
+        return text.substr(start, position - start);
+    }
+
+    size_t addNode(ExpressionKind kind, std::vector<size_t> children) {
+        Node node;
+        node.kind = kind;
+        // Вложенные AND в AND и OR в OR сливаются в один узел
+        for (size_t child : children) {
+            if (kind != ExpressionKind::Not && expression.nodes[child].kind == kind) {
+                const std::vector<size_t>& nested = expression.nodes[child].children;
+                node.children.insert(node.children.end(), nested.begin(), nested.end());
+            }
+            else {
+                node.children.push_back(child);
+            }
+        }
+        expression.nodes.push_back(std::move(node));
+        return expression.nodes.size() - 1;
+    }
+
+    bool parseLeaf(size_t& node) {
+        size_t start = position;
+        if (takeWord().empty()) {
+            return false;
+        }
+        skipSpaces();
+        if (takeWord().empty()) {
+            return false;
+        }
+        // Значение тянется до AND/OR; ')' закрывает группу, только если не парна '(' внутри значения
+        size_t end = position;
+        int balance = 0;
+        while (true) {
+            skipSpaces();
+            if (position >= text.size() || atKeyword("AND") || atKeyword("OR")) {
+                break;
+            }
+            bool closed = false;
+            while (position < text.size() && !isSpace(text[position])) {
+                if (text[position] == '(') {
+                    ++balance;
+                }
+                else if (text[position] == ')') {
+                    if (balance == 0 && depth > 0) {
+                        closed = true;
+                        break;
+                    }
+                    if (balance > 0) {
+                        --balance;
+                    }
+                }
+                ++position;
+            }
+            end = position;
+            if (closed) {
+                break;
+            }
+        }
+        position = end;
+
+        Condition condition = Condition::compile(std::string(text.substr(start, end - start)));
+        if (condition.getField() == ConditionField::Unknown || condition.getOp() == ConditionOp::Unknown) {
+            return false;
+        }
+        expression.conditions.push_back(std::move(condition));
+        Node leaf;
+        leaf.condition = expression.conditions.size() - 1;
+        expression.nodes.push_back(std::move(leaf));
+        node = expression.nodes.size() - 1;
+        return true;
+    }
+
+    bool parseUnary(size_t& node) {
+        skipSpaces();
+        if (takeKeyword("NOT")) {
+            size_t child;
+            if (!parseUnary(child)) {
+                return false;
+            }
+            node = addNode(ExpressionKind::Not, { child });
+            return true;
+        }
+        if (position < text.size() && text[position] == '(') {
+            ++position;
+            ++depth;
+            compound = true;
+            if (!parseOr(node)) {
+                return false;
+            }
+            skipSpaces();
+            if (position >= text.size() || text[position] != ')') {
+                return false;
+            }
+            ++position;
+            --depth;
+            return true;
+        }
+        return parseLeaf(node);
+    }
+
+    bool parseAnd(size_t& node) {
+        std::vector<size_t> children(1);
+        if (!parseUnary(children[0])) {
+            return false;
+        }
+        while (true) {
+            skipSpaces();
+            if (!takeKeyword("AND")) {
+                break;
+            }
+            children.emplace_back();
+            if (!parseUnary(children.back())) {
+                return false;
+            }
+        }
+        node = children.size() == 1 ? children[0] : addNode(ExpressionKind::And, std::move(children));
+        return true;
+    }
+
+    bool parseOr(size_t& node) {
+        std::vector<size_t> children(1);
+        if (!parseAnd(children[0])) {
+            return false;
+        }
+        while (true) {
+            skipSpaces();
+            if (!takeKeyword("OR")) {
+                break;
+            }
+            children.emplace_back();
+            if (!parseAnd(children.back())) {
+                return false;
+            }
+        }
+        node = children.size() == 1 ? children[0] : addNode(ExpressionKind::Or, std::move(children));
+        return true;
+    }
+
+public:
+    Parser(std::string_view text, ConditionExpression& expression) : text(text), expression(expression) {}
+
+    // Ложь, если текст не разбирается или в нем нет ни одного оператора
+    bool parseCompound() {
+        if (!parseOr(expression.root)) {
+            return false;
+        }
+        skipSpaces();
+        return position == text.size() && compound;
+    }
+};
+
+ConditionExpression::ConditionExpression() = default;
+
+ConditionExpression ConditionExpression::compile(const std::string& text) {
+    ConditionExpression result;
+    result.text = text;
+    Parser parser(text, result);
+    if (!parser.parseCompound()) {
+        result.conditions.assign(1, Condition::compile(text));
+        result.nodes.assign(1, Node());
+        result.root = 0;
+    }
+
+    // Узлы создаются после своих потомков, поэтому стоимость считается одним проходом
+    for (Node& node : result.nodes) {
+        switch (node.kind) {
+        case ExpressionKind::Leaf:
+            node.cost = leafCost(result.conditions[node.condition]);
+            break;
+        case ExpressionKind::Not:
+            node.cost = result.nodes[node.children.front()].cost;
+            break;
+        case ExpressionKind::And:
+        case ExpressionKind::Or:
+            std::stable_sort(node.children.begin(), node.children.end(), [&result](size_t left, size_t right) {
+                return result.nodes[left].cost < result.nodes[right].cost;
+            });
+            node.cost = 0;
+            for (size_t child : node.children) {
+                node.cost += result.nodes[child].cost;
+            }
+            break;
+        }
+    }
+    return result;
+}
+
+const std::string& ConditionExpression::getText() const {
+    return text;
+}
+
+bool ConditionExpression::isSingle() const {
+    return nodes[root].kind == ExpressionKind::Leaf;
+}
+
+const Condition& ConditionExpression::getSingle() const {
+    return conditions[nodes[root].condition];
+}
+
+const std::vector<Condition>& ConditionExpression::getConditions() const {
+    return conditions;
+}
+
+ExpressionKind ConditionExpression::getKind() const {
+    return nodes[root].kind;
+}
+
+unsigned ConditionExpression::getCost() const {
+    return nodes[root].cost;
+}
+
+bool ConditionExpression::getOperands(std::vector<const Condition*>& operands) const {
+    operands.clear();
+    const Node& current = nodes[root];
+    if (current.kind == ExpressionKind::Leaf) {
+        operands.push_back(&conditions[current.condition]);
+        return true;
+    }
+    bool onlyLeaves = true;
+    for (size_t child : current.children) {
+        if (nodes[child].kind == ExpressionKind::Leaf) {
+            operands.push_back(&conditions[nodes[child].condition]);
+        }
+        else {
+            onlyLeaves = false;
+        }
+    }
+    return onlyLeaves;
+}
+
+bool ConditionExpression::matches(const Film& film) const {
+    return evaluate([&film](const Condition& condition) {
+        return film.matches(condition);
+    });
+}
+
+unsigned ConditionExpression::candidateTypes(const std::function<unsigned(const Condition&)>& leafTypes, unsigned allTypes) const {
+    return typesOf(root, leafTypes, allTypes);
+}
+
+unsigned ConditionExpression::typesOf(size_t node, const std::function<unsigned(const Condition&)>& leafTypes, unsigned allTypes) const {
+    const Node& current = nodes[node];
+    switch (current.kind) {
+    case ExpressionKind::Leaf:
+        return leafTypes(conditions[current.condition]);
+    case ExpressionKind::And: {
+        unsigned types = allTypes;
+        for (size_t child : current.children) {
+            types &= typesOf(child, leafTypes, allTypes);
+        }
+        return types;
+    }
+    case ExpressionKind::Or: {
+        unsigned types = 0;
+        for (size_t child : current.children) {
+            types |= typesOf(child, leafTypes, allTypes);
+        }
+        return types;
+    }
+    case ExpressionKind::Not:
+        break;
+    }
+    return allTypes;
+}
+
+unsigned ConditionExpression::leafCost(const Condition& condition) {
+    // Сравнение тега и чисел дешевле сравнения строк, contains дороже всего
+    switch (condition.getField()) {
+    case ConditionField::Episodes:
+    case ConditionField::AnimationType:
+        return 2;
+    case ConditionField::Title:
+    case ConditionField::Director:
+        if (condition.getOp() == ConditionOp::Contains) {
+            return 8;
+        }
+        return condition.getOp() == ConditionOp::Equal || condition.getOp() == ConditionOp::NotEqual ? 3 : 4;
+    default:
+        return 1;
+    }
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "Condition.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+class Film;
+
+enum class ExpressionKind
+{
+	Leaf,
+	And,
+	Or,
+	Not,
+};
+
+// Логическое выражение над условиями: AND, OR, NOT и скобки. Разбирается один раз,
+// операнды AND и OR упорядочены по возрастанию стоимости проверки
+class ConditionExpression
+{
+private:
+	struct Node
+	{
+		ExpressionKind kind = ExpressionKind::Leaf;
+		size_t condition = 0;
+		std::vector<size_t> children;
+		unsigned cost = 0;
+	};
+
+	std::string text;
+	std::vector<Condition> conditions;
+	std::vector<Node> nodes;
+	size_t root = 0;
+
+	class Parser;
+
+	ConditionExpression();
+
+	template <typename MatchLeaf>
+	bool evaluateNode(size_t node, MatchLeaf& matchLeaf) const;
+	unsigned typesOf(size_t node, const std::function<unsigned(const Condition&)>& leafTypes, unsigned allTypes) const;
+
+public:
+	// Текст без AND, OR, NOT и скобок, а также текст, не разбирающийся как выражение,
+	// становится одним условием, как и раньше
+	static ConditionExpression compile(const std::string& text);
+
+	const std::string& getText() const;
+	bool isSingle() const;
+	const Condition& getSingle() const;
+	const std::vector<Condition>& getConditions() const;
+	ExpressionKind getKind() const;
+	unsigned getCost() const;
+	// Простые условия среди операндов корня в порядке проверки; true, если других операндов нет
+	bool getOperands(std::vector<const Condition*>& operands) const;
+
+	// Проверка с сокращенным вычислением; matchLeaf проверяет одно условие
+	template <typename MatchLeaf>
+	bool evaluate(MatchLeaf matchLeaf) const {
+		return evaluateNode(root, matchLeaf);
+	}
+	bool matches(const Film& film) const;
+
+	// Типы фильмов, которые могут подойти: пересечение для AND, объединение для OR
+	unsigned candidateTypes(const std::function<unsigned(const Condition&)>& leafTypes, unsigned allTypes) const;
+
+	static unsigned leafCost(const Condition& condition);
+};
+
+template <typename MatchLeaf>
+bool ConditionExpression::evaluateNode(size_t node, MatchLeaf& matchLeaf) const {
+	const Node& current = nodes[node];
+	switch (current.kind) {
+	case ExpressionKind::Leaf:
+		return matchLeaf(conditions[current.condition]);
+	case ExpressionKind::And:
+		for (size_t child : current.children) {
+			if (!evaluateNode(child, matchLeaf)) {
+				return false;
+			}
+		}
+		return true;
+	case ExpressionKind::Or:
+		for (size_t child : current.children) {
+			if (evaluateNode(child, matchLeaf)) {
+				return true;
+			}
+		}
+		return false;
+	case ExpressionKind::Not:
+		return !evaluateNode(current.children.front(), matchLeaf);
+	}
+	return false;
+}
@@ -0,0 +1,58 @@
+#include "FileReplace.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool syncFile(const std::string& filename) {
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool synced = FlushFileBuffers(handle) != 0;
+    CloseHandle(handle);
+    return synced;
+#else
+    int fd = open(filename.c_str(), O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+#endif
+}
+
+#ifndef _WIN32
+// Запись о переименовании хранится в каталоге; без его сброса замена может не пережить сбой питания
+static void syncDirectoryOf(const std::string& filename) {
+    size_t slash = filename.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : slash == 0 ? "/" : filename.substr(0, slash);
+    int fd = open(directory.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+#endif
+
+bool replaceFile(const std::string& source, const std::string& target) {
+#ifdef _WIN32
+    return MoveFileExA(source.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    // rename поверх существующего файла атомарен: читатель видит либо старый, либо новый файл
+    if (std::rename(source.c_str(), target.c_str()) != 0) {
+        return false;
+    }
+    syncDirectoryOf(target);
+    return true;
+#endif
+}
@@ -0,0 +1,9 @@
+#pragma once
+#include <string>
+
+// Дописывает содержимое файла на диск; false, если система не подтвердила запись
+bool syncFile(const std::string& filename);
+
+// Заменяет target файлом source одной операцией: при неудаче target остается прежним.
+// source должен быть уже записан на диск через syncFile
+bool replaceFile(const std::string& source, const std::string& target);
@@ -1,7 +1,18 @@
 #include "Film.h"
+#include "Condition.h"
 
 Film::Film(const std::string& title) : title(title) {}
 
 const std::string& Film::getTitle() const {
-	return title;
+	return title.str();
+}
+
+void Film::print() const {
+	OutputSink& output = standardOutput();
+	print(output);
+	output.flush();
+}
+
+bool Film::matchesCondition(const std::string& condition) const {
+	return matches(Condition::compile(condition));
 }
\ No newline at end of file
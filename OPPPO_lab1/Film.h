@@ -1,20 +1,40 @@
 #pragma once
 #include <string>
 #include <iostream>
+#include "OutputSink.h"
+#include "StringPool.h"
+
+class Condition;
+
+enum class FilmType
+{
+	Game,
+	Cartoon,
+	Series,
+};
+
+constexpr size_t FILM_TYPE_COUNT = 3;
 
 class Film
 {
 protected:
-	std::string title;
+	InternedString title;
 
 public:
 	Film(const std::string& title);
+	Film(const Film&) = default;
+	Film(Film&&) = default;
+	Film& operator=(const Film&) = default;
+	Film& operator=(Film&&) = default;
 	virtual ~Film() = default;
 
 	const std::string& getTitle() const;
 
-	virtual void print() const = 0;
-	virtual bool matchesCondition(const std::string& consition) const = 0;
+	void print() const;
+	virtual void print(OutputSink& output) const = 0;
+	virtual bool matches(const Condition& condition) const = 0;
+	bool matchesCondition(const std::string& condition) const;
 	virtual std::string getType() const = 0;
+	virtual FilmType getTypeTag() const = 0;
 };
 
@@ -1,99 +1,1292 @@
 #include "FilmContainer.h"
+#include "FilmSnapshot.h"
+#include "FilmJournal.h"
+#include "FilmIndex.h"
+#include "SeriesFilm.h"
+#include "ThreadPool.h"
 #include <algorithm>
-#include <iostream>
+#include <limits>
 #include <sstream>
+#include <stdexcept>
 
-void FilmContainer::addFilm(std::unique_ptr<Film> film) {
+// Имена типов в условии type == X, по порядку FilmType
+static const char* const TYPE_NAMES[FILM_TYPE_COUNT] = { "game", "cartoon", "series" };
+
+// Стоимость обработки фильма, найденного индексом, в единицах проверки простого условия при просмотре:
+// поиск в индексе, переход к ячейке и произвольный доступ к разделу
+static constexpr double INDEX_PROBE_COST = 4.0;
+
+static constexpr unsigned ALL_TYPES = (1u << FILM_TYPE_COUNT) - 1;
+
+// Меньший раздел дешевле проверить в одном потоке, чем раздать кусками
+static constexpr size_t PARALLEL_REMOVAL_MIN_FILMS = 1 << 14;
+
+template <typename T>
+static void reserveFor(std::vector<T>& items, size_t count) {
+    size_t required = items.size() + count;
+    if (required > items.capacity()) {
+        items.reserve(std::max(required, items.capacity() * 2));
+    }
+}
+
+size_t FilmContainer::Partition::liveCount() const {
+    return films.size() - deadCount;
+}
+
+void FilmContainer::Partition::compact(std::vector<Slot>& slots) {
+    size_t write = 0;
+    for (size_t read = 0; read < films.size(); ++read) {
+        if (dead[read]) {
+            continue;
+        }
+        if (write != read) {
+            films[write] = std::move(films[read]);
+            episodes[write] = episodes[read];
+            sequence[write] = sequence[read];
+            slot[write] = slot[read];
+            slots[slot[write]].position = write;
+        }
+        ++write;
+    }
+    films.resize(write);
+    episodes.resize(write);
+    sequence.resize(write);
+    slot.resize(write);
+    dead.assign(write, false);
+    deadCount = 0;
+    titles.clear();
+    directors.clear();
+}
+
+void FilmContainer::Partition::clear() {
+    films.clear();
+    episodes.clear();
+    sequence.clear();
+    slot.clear();
+    dead.clear();
+    deadCount = 0;
+    titles.clear();
+    directors.clear();
+}
+
+FilmContainer::FilmContainer(OutputSink& output, std::pmr::memory_resource* resource)
+    : output(&output), resource(resource), parallelRemovalThreshold(PARALLEL_REMOVAL_MIN_FILMS) {}
+
+FilmContainer::~FilmContainer() = default;
+
+void FilmContainer::setOutput(OutputSink& sink) {
+    output = &sink;
+}
+
+OutputSink& FilmContainer::getOutput() const {
+    return *output;
+}
+
+FilmId FilmContainer::place(FilmPtr film) {
+    size_t type = static_cast<size_t>(film->getTypeTag());
+    Partition& partition = partitions[type];
+    uint32_t index;
+    if (freeSlots.empty()) {
+        index = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+    }
+    else {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    Slot& slot = slots[index];
+    slot.type = static_cast<uint32_t>(type);
+    slot.position = partition.films.size();
+
+    partition.sequence.push_back(nextSequence++);
+    partition.episodes.push_back(type == static_cast<size_t>(FilmType::Series)
+        ? static_cast<const SeriesFilm&>(*film).getEpisode() : 0);
+    partition.films.push_back(std::move(film));
+    partition.slot.push_back(index);
+    partition.dead.push_back(false);
+    indexFilm(*partition.films.back(), index);
+    return idAt(partition, partition.films.size() - 1);
+}
+
+void FilmContainer::killFilm(Partition& partition, size_t position) {
+    partition.dead[position] = true;
+    ++partition.deadCount;
+    if (collectRemoved) {
+        removedSequences.push_back(partition.sequence[position]);
+    }
+    releaseSlot(partition.slot[position]);
+}
+
+void FilmContainer::releaseSlot(uint32_t index) {
+    // Старые идентификаторы ячейки перестают совпадать; исчерпавшая поколения ячейка больше не выдается
+    Slot& slot = slots[index];
+    if (slot.generation < UINT32_MAX) {
+        ++slot.generation;
+        freeSlots.push_back(index);
+    }
+}
+
+void FilmContainer::clearFilms() {
+    // Ячейки остаются: выданные до очистки идентификаторы не должны совпасть с новыми фильмами
+    for (Partition& partition : partitions) {
+        for (size_t position = 0; position < partition.films.size(); ++position) {
+            if (!partition.dead[position]) {
+                releaseSlot(partition.slot[position]);
+            }
+        }
+        partition.clear();
+    }
+}
+
+FilmId FilmContainer::idAt(const Partition& partition, size_t position) const {
+    uint32_t index = partition.slot[position];
+    return (static_cast<FilmId>(slots[index].generation) << 32) | index;
+}
+
+const Film* FilmContainer::findById(FilmId id, Partition*& partition, size_t& position) {
+    uint64_t index = id & UINT32_MAX;
+    if (index >= slots.size() || slots[index].generation != (id >> 32)) {
+        return nullptr;
+    }
+    const Slot& slot = slots[index];
+    partition = &partitions[slot.type];
+    position = slot.position;
+    if (position >= partition->films.size() || partition->slot[position] != index || partition->dead[position]) {
+        return nullptr;
+    }
+    return partition->films[position].get();
+}
+
+template <typename Visit>
+void FilmContainer::visitOrdered(unsigned types, Visit visit) const {
+    // Слияние живых фильмов разделов по номеру добавления; visit возвращает false, чтобы остановиться
+    std::array<size_t, FILM_TYPE_COUNT> next{};
+    size_t remaining = 0;
+    for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+        if (types & (1u << type)) {
+            remaining += partitions[type].liveCount();
+        }
+        else {
+            next[type] = partitions[type].films.size();
+        }
+    }
+    for (; remaining > 0; --remaining) {
+        size_t best = FILM_TYPE_COUNT;
+        for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+            const Partition& partition = partitions[type];
+            while (next[type] < partition.films.size() && partition.dead[next[type]]) {
+                ++next[type];
+            }
+            if (next[type] < partition.films.size()
+                && (best == FILM_TYPE_COUNT || partition.sequence[next[type]] < partitions[best].sequence[next[best]])) {
+                best = type;
+            }
+        }
+        if (!visit(partitions[best], next[best]++)) {
+            return;
+        }
+    }
+}
+
+std::vector<const Film*> FilmContainer::orderedFilms() const {
+    std::vector<const Film*> ordered;
+    ordered.reserve(size());
+    visitOrdered(ALL_TYPES, [&](const Partition& partition, size_t position) {
+        ordered.push_back(partition.films[position].get());
+        return true;
+    });
+    return ordered;
+}
+
+FilmId FilmContainer::addFilm(std::unique_ptr<Film> film) {
     if (!film) {
-        std::cout << "Error: Cannot add null film" << std::endl;
+        *output << "Error: Cannot add null film\n";
+        return INVALID_FILM_ID;
+    }
+    if (journal) {
+        journal->appendAdd(*film);
+        journal->commit();
+    }
+    FilmId id = place(FilmPtr(film.release()));
+    *output << "Film added successfully\n";
+    return id;
+}
+
+FilmId FilmContainer::addFilm(FilmValue film) {
+    if (journal) {
+        journal->appendAdd(asFilm(film));
+        journal->commit();
+    }
+    FilmId id = place(allocateFilm(std::move(film), *resource));
+    *output << "Film added successfully\n";
+    return id;
+}
+
+void FilmContainer::indexFilm(const Film& film, uint32_t slot) {
+    if (!hasIndexes()) {
         return;
     }
-    films.push_back(std::move(film));
-    std::cout << "Film added successfully" << std::endl;
+    slotOf.emplace(&film, slot);
+    statistics->insert(film);
+    if (titleIndex) {
+        titleIndex->insert(film);
+    }
+    if (directorIndex) {
+        directorIndex->insert(film);
+    }
+    if (episodeIndex) {
+        episodeIndex->insert(film);
+    }
+    if (titleTrigrams) {
+        titleTrigrams->insert(film);
+        directorTrigrams->insert(film);
+    }
+}
+
+void FilmContainer::unindexFilms(const std::vector<const Film*>& removed) {
+    if (!hasIndexes()) {
+        return;
+    }
+    for (const Film* film : removed) {
+        slotOf.erase(film);
+    }
+    statistics->erase(removed);
+    if (titleIndex) {
+        titleIndex->erase(removed);
+    }
+    if (directorIndex) {
+        directorIndex->erase(removed);
+    }
+    if (episodeIndex) {
+        episodeIndex->erase(removed);
+    }
+    if (titleTrigrams) {
+        titleTrigrams->erase(removed);
+        directorTrigrams->erase(removed);
+    }
+}
+
+bool FilmContainer::hasIndexes() const {
+    return titleIndex || directorIndex || episodeIndex || titleTrigrams;
+}
+
+void FilmContainer::rebuildIndexes() {
+    slotOf.clear();
+    if (!hasIndexes()) {
+        statistics.reset();
+        return;
+    }
+    std::vector<const Film*> all;
+    all.reserve(size());
+    for (const Partition& partition : partitions) {
+        for (size_t i = 0; i < partition.films.size(); ++i) {
+            if (!partition.dead[i]) {
+                all.push_back(partition.films[i].get());
+                slotOf.emplace(partition.films[i].get(), partition.slot[i]);
+            }
+        }
+    }
+    if (!statistics) {
+        statistics = std::make_unique<FilmStatistics>();
+    }
+    statistics->rebuild(all);
+    if (titleIndex) {
+        titleIndex->rebuild(all);
+    }
+    if (directorIndex) {
+        directorIndex->rebuild(all);
+    }
+    if (episodeIndex) {
+        episodeIndex->rebuild(all);
+    }
+    if (titleTrigrams) {
+        titleTrigrams->rebuild(all);
+        directorTrigrams->rebuild(all);
+    }
+}
+
+bool FilmContainer::findIndexed(const Condition& condition, std::vector<const Film*>& targets) const {
+    bool equal = condition.getOp() == ConditionOp::Equal;
+    bool contains = condition.getOp() == ConditionOp::Contains;
+    switch (condition.getField()) {
+    case ConditionField::Title:
+        if (titleIndex && equal) {
+            targets = titleIndex->find(condition.getValue());
+            return true;
+        }
+        return titleTrigrams && contains && titleTrigrams->find(condition.getValue(), targets);
+    case ConditionField::Director:
+        if (directorIndex && equal) {
+            targets = directorIndex->find(condition.getValue());
+            return true;
+        }
+        return directorTrigrams && contains && directorTrigrams->find(condition.getValue(), targets);
+    case ConditionField::Episodes:
+        if (episodeIndex) {
+            targets = episodeIndex->find(condition);
+            return true;
+        }
+        return false;
+    default:
+        return false;
+    }
+}
+
+double FilmContainer::probeCost(const Condition& condition) const {
+    // Ожидаемое число найденных индексом фильмов; бесконечность, если индекс к условию неприменим
+    double found = std::numeric_limits<double>::infinity();
+    bool equal = condition.getOp() == ConditionOp::Equal;
+    bool contains = condition.getOp() == ConditionOp::Contains;
+    switch (condition.getField()) {
+    case ConditionField::Title:
+        if (titleIndex && equal) {
+            found = static_cast<double>(titleIndex->count(condition.getValue()));
+        }
+        else if (titleTrigrams && contains && titleTrigrams->estimate(condition.getValue()) != SIZE_MAX) {
+            found = static_cast<double>(titleTrigrams->estimate(condition.getValue()));
+        }
+        break;
+    case ConditionField::Director:
+        if (directorIndex && equal) {
+            found = static_cast<double>(statistics->countDirector(condition.getValue()));
+        }
+        else if (directorTrigrams && contains && directorTrigrams->estimate(condition.getValue()) != SIZE_MAX) {
+            found = static_cast<double>(directorTrigrams->estimate(condition.getValue()));
+        }
+        break;
+    case ConditionField::Episodes:
+        if (episodeIndex) {
+            found = statistics->estimateEpisodes(condition);
+        }
+        break;
+    default:
+        break;
+    }
+    return found * INDEX_PROBE_COST;
+}
+
+double FilmContainer::scanCost(unsigned types, unsigned filmCost) const {
+    size_t films = 0;
+    for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+        if (types & (1u << type)) {
+            films += partitions[type].liveCount();
+        }
+    }
+    return static_cast<double>(films) * filmCost;
+}
+
+bool FilmContainer::planExpression(const ConditionExpression& expression, unsigned types,
+    std::vector<const Film*>& candidates) const {
+    // AND сужается самым дешевым индексируемым операндом, OR - объединением индексов всех операндов
+    std::vector<const Condition*> operands;
+    bool onlyLeaves = expression.getOperands(operands);
+    double scan = scanCost(types, expression.getCost());
+    if (expression.getKind() == ExpressionKind::And) {
+        const Condition* best = nullptr;
+        double bestCost = scan;
+        for (const Condition* operand : operands) {
+            double cost = probeCost(*operand);
+            if (cost < bestCost) {
+                best = operand;
+                bestCost = cost;
+            }
+        }
+        return best && findIndexed(*best, candidates);
+    }
+    if (expression.getKind() != ExpressionKind::Or || !onlyLeaves) {
+        return false;
+    }
+    double total = 0;
+    for (const Condition* operand : operands) {
+        total += probeCost(*operand);
+    }
+    if (!(total < scan)) {
+        return false;
+    }
+    std::vector<const Film*> found;
+    for (const Condition* operand : operands) {
+        if (!findIndexed(*operand, found)) {
+            return false;
+        }
+        candidates.insert(candidates.end(), found.begin(), found.end());
+    }
+    return true;
+}
+
+unsigned FilmContainer::markFilms(const std::vector<const Film*>& targets) {
+    // Позиция фильма берется из его ячейки, остальные фильмы не трогаются
+    unsigned touched = 0;
+    for (const Film* film : targets) {
+        const Slot& slot = slots[slotOf.at(film)];
+        killFilm(partitions[slot.type], slot.position);
+        touched |= 1u << slot.type;
+    }
+    return touched;
+}
+
+size_t FilmContainer::dropPartition(Partition& partition) {
+    if (hasIndexes()) {
+        std::vector<const Film*> removed;
+        removed.reserve(partition.liveCount());
+        for (size_t i = 0; i < partition.films.size(); ++i) {
+            if (!partition.dead[i]) {
+                removed.push_back(partition.films[i].get());
+            }
+        }
+        unindexFilms(removed);
+    }
+    size_t removedCount = partition.liveCount();
+    for (size_t i = 0; i < partition.films.size(); ++i) {
+        if (!partition.dead[i]) {
+            killFilm(partition, i);
+        }
+    }
+    partition.clear();
+    return removedCount;
+}
+
+void FilmContainer::compactIfNeeded(Partition& partition) {
+    if (partition.liveCount() == 0) {
+        partition.clear();
+    }
+    else if (partition.deadCount > 0 && partition.deadCount > compactionThreshold * partition.films.size()) {
+        partition.compact(slots);
+    }
+}
+
+unsigned FilmContainer::candidateTypes(const Condition& condition) {
+    const unsigned game = 1u << static_cast<unsigned>(FilmType::Game);
+    const unsigned cartoon = 1u << static_cast<unsigned>(FilmType::Cartoon);
+    const unsigned series = 1u << static_cast<unsigned>(FilmType::Series);
+    switch (condition.getField()) {
+    case ConditionField::Title: return game | cartoon | series;
+    case ConditionField::Director: return game | series;
+    case ConditionField::AnimationType: return cartoon;
+    case ConditionField::Episodes: return series;
+    case ConditionField::Id: return game | cartoon | series;
+    case ConditionField::Type: {
+        unsigned types = 0;
+        for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+            if (condition.matchesType(TYPE_NAMES[type])) {
+                types |= 1u << type;
+            }
+        }
+        return types;
+    }
+    default: return 0;
+    }
+}
+
+void FilmContainer::reportBatch(size_t added, size_t rejected) const {
+    if (rejected > 0) {
+        *output << "Error: Cannot add " << rejected << " null film(s)\n";
+    }
+    *output << "Added " << added << " film(s) successfully\n";
+    output->flush();
+}
+
+void FilmContainer::reservePartitions(const std::array<size_t, FILM_TYPE_COUNT>& counts) {
+    for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+        reserveFor(partitions[type].films, counts[type]);
+        reserveFor(partitions[type].episodes, counts[type]);
+        reserveFor(partitions[type].sequence, counts[type]);
+        reserveFor(partitions[type].slot, counts[type]);
+        reserveFor(partitions[type].dead, counts[type]);
+    }
+}
+
+void FilmContainer::addFilms(std::vector<std::unique_ptr<Film>> batch) {
+    std::array<size_t, FILM_TYPE_COUNT> counts{};
+    for (const auto& film : batch) {
+        if (film) {
+            ++counts[static_cast<size_t>(film->getTypeTag())];
+        }
+    }
+    reservePartitions(counts);
+    size_t added = 0;
+    for (size_t count : counts) {
+        added += count;
+    }
+    for (auto& film : batch) {
+        if (film) {
+            if (journal) {
+                journal->appendAdd(*film);
+            }
+            place(FilmPtr(film.release()));
+        }
+    }
+    if (journal) {
+        journal->commit();
+    }
+    reportBatch(added, batch.size() - added);
+}
+
+void FilmContainer::addFilms(std::vector<FilmValue> batch) {
+    std::array<size_t, FILM_TYPE_COUNT> counts{};
+    for (const FilmValue& film : batch) {
+        ++counts[static_cast<size_t>(asFilm(film).getTypeTag())];
+    }
+    reservePartitions(counts);
+    for (FilmValue& film : batch) {
+        if (journal) {
+            journal->appendAdd(asFilm(film));
+        }
+        place(allocateFilm(std::move(film), *resource));
+    }
+    if (journal) {
+        journal->commit();
+    }
+    reportBatch(batch.size(), 0);
+}
+
+void FilmContainer::addFilms(size_t count, const std::function<std::unique_ptr<Film>(size_t)>& generator) {
+    // Тип фильма известен только после генерации, поэтому разделы резервируются по готовой пачке
+    std::vector<std::unique_ptr<Film>> batch;
+    batch.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        batch.push_back(generator(i));
+    }
+    addFilms(std::move(batch));
 }
 
 void FilmContainer::removeFilms(const std::string& condition) {
     if (condition.empty()) {
-        std::cout << "Error: Empty condition provided" << std::endl;
+        *output << "Error: Empty condition provided\n";
+        output->flush();
         return;
     }
 
-    if (films.empty()) {
-        std::cout << "No films to remove - container is empty" << std::endl;
+    removeFilms(ConditionExpression::compile(condition));
+}
+
+template <typename Predicate>
+size_t FilmContainer::markMatching(unsigned types, Predicate matches, std::vector<const Film*>& targets, unsigned& touched) {
+    // Просматриваются только живые фильмы разделов тех типов, которые могут подойти под условие
+    size_t removedCount = 0;
+    bool indexed = hasIndexes();
+    for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+        Partition& partition = partitions[type];
+        if (!(types & (1u << type)) || partition.liveCount() == 0) {
+            continue;
+        }
+        size_t count = partition.films.size();
+        bool parallel = removalPool && count >= parallelRemovalThreshold;
+        if (parallel) {
+            // Потоки только читают раздел и пишут каждый в свою часть removalHits
+            removalHits.assign(count, 0);
+            removalPool->parallelFor(count, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    removalHits[i] = !partition.dead[i] && matches(partition, i);
+                }
+            });
+        }
+        // Пометка всегда идет по возрастанию позиций: ячейки освобождаются в том же порядке, что без потоков
+        for (size_t i = 0; i < count; ++i) {
+            if (parallel ? removalHits[i] != 0 : !partition.dead[i] && matches(partition, i)) {
+                killFilm(partition, i);
+                ++removedCount;
+                if (indexed) {
+                    targets.push_back(partition.films[i].get());
+                }
+            }
+        }
+        touched |= 1u << type;
+    }
+    return removedCount;
+}
+
+size_t FilmContainer::markContaining(const Condition& condition, unsigned types,
+    std::vector<const Film*>& targets, unsigned& touched) {
+    // Строки фильмов раздела склеены заранее и проверяются одним векторным проходом вместо поиска в каждой;
+    // склеиваются только фильмы, добавленные после прошлого поиска
+    bool byTitle = condition.getField() == ConditionField::Title;
+    FilmKeyFunction key = byTitle ? filmTitle : filmDirector;
+    size_t removedCount = 0;
+    bool indexed = hasIndexes();
+    std::vector<unsigned char> hits;
+    for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+        Partition& partition = partitions[type];
+        if (!(types & (1u << type)) || partition.liveCount() == 0) {
+            continue;
+        }
+        BatchSearch& batch = byTitle ? partition.titles : partition.directors;
+        for (size_t i = batch.size(); i < partition.films.size(); ++i) {
+            batch.add(*key(*partition.films[i]));
+        }
+        batch.containsEach(condition.getValue(), hits);
+        for (size_t i = 0; i < hits.size(); ++i) {
+            if (hits[i] && !partition.dead[i]) {
+                killFilm(partition, i);
+                ++removedCount;
+                if (indexed) {
+                    targets.push_back(partition.films[i].get());
+                }
+            }
+        }
+        touched |= 1u << type;
+    }
+    return removedCount;
+}
+
+size_t FilmContainer::markEpisodes(const Condition& condition, std::vector<const Film*>& targets, unsigned& touched) {
+    // Сравнение идет по столбцу чисел серий без обращения к фильмам; удаленные отсеиваются по dead
+    const size_t type = static_cast<size_t>(FilmType::Series);
+    Partition& partition = partitions[type];
+    if (partition.liveCount() == 0 || !condition.hasNumber()
+        || !selectNumbers(partition.episodes.data(), partition.episodes.size(), condition.getOp(), condition.getNumber(),
+            selection)) {
+        return 0;
+    }
+    size_t removedCount = 0;
+    bool indexed = hasIndexes();
+    forEachSelected(selection, [&](size_t position) {
+        if (!partition.dead[position]) {
+            killFilm(partition, position);
+            ++removedCount;
+            if (indexed) {
+                targets.push_back(partition.films[position].get());
+            }
+        }
+    });
+    touched |= 1u << type;
+    return removedCount;
+}
+
+bool FilmContainer::matchesAt(const Partition& partition, size_t position, const Condition& condition) const {
+    if (condition.getField() == ConditionField::Id) {
+        return condition.matchesId(idAt(partition, position));
+    }
+    return partition.films[position]->matches(condition);
+}
+
+void FilmContainer::checkIdCondition(const Condition& condition) {
+    if (condition.getField() == ConditionField::Id && (!condition.hasId()
+        || (condition.getOp() != ConditionOp::Equal && condition.getOp() != ConditionOp::NotEqual))) {
+        throw std::invalid_argument("id condition must have the form 'id == N' or 'id != N'");
+    }
+}
+
+void FilmContainer::runRemoval(const std::string& text, bool byId,
+    const std::function<size_t(std::vector<const Film*>&, unsigned&)>& mark) {
+    if (size() == 0) {
+        *output << "No films to remove - container is empty\n";
+        output->flush();
         return;
     }
 
     try {
-        auto newEnd = std::remove_if(films.begin(), films.end(),
-            [&condition](const std::unique_ptr<Film>& film) {
-                return film->matchesCondition(condition);
-            });
-
-        int removedCount = films.end() - newEnd;
-        films.erase(newEnd, films.end());
-        std::cout << "Successfully removed " << removedCount << " film(s)" << std::endl;
+        std::vector<const Film*> targets;
+        unsigned touched = 0;
+        removedSequences.clear();
+        collectRemoved = journal && byId;
+        size_t removedCount = mark(targets, touched);
+        collectRemoved = false;
+        // Помеченные фильмы еще живы, поэтому индексы правятся до уплотнения
+        unindexFilms(targets);
+        for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+            if (touched & (1u << type)) {
+                compactIfNeeded(partitions[type]);
+            }
+        }
+        *output << "Successfully removed " << removedCount << " film(s)\n";
+        if (journal && removedCount > 0) {
+            // Идентификаторы при воспроизведении выдаются заново, поэтому удаление по id пишется
+            // через номера добавления, которые журнал воспроизводит в том же порядке
+            if (byId) {
+                for (uint64_t sequence : removedSequences) {
+                    journal->appendDelete(sequence);
+                }
+            }
+            else {
+                journal->appendRemove(text);
+            }
+            if (journal->needsCompaction(size())) {
+                compactJournal();
+            }
+            journal->commit();
+        }
     }
     catch (const std::exception& e) {
-        std::cout << "Error removing films: " << e.what() << std::endl;
+        collectRemoved = false;
+        *output << "Error removing films: " << e.what() << '\n';
     }
     catch (...) {
-        std::cout << "Unknown error occurred while removing films" << std::endl;
+        collectRemoved = false;
+        *output << "Unknown error occurred while removing films\n";
     }
+    output->flush();
 }
 
-void FilmContainer::printAll() const {
-    if (films.empty()) {
-        std::cout << "Container is empty" << std::endl;
+void FilmContainer::removeFilms(const Condition& condition) {
+    bool byId = condition.getField() == ConditionField::Id;
+    runRemoval(condition.getText(), byId, [&](std::vector<const Film*>& targets, unsigned& touched) {
+        size_t removedCount = 0;
+        unsigned types = candidateTypes(condition);
+        if (condition.getField() == ConditionField::Type) {
+            // type == X совпадает со всем разделом, он удаляется целиком без проверки фильмов
+            for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+                if (types & (1u << type)) {
+                    removedCount += dropPartition(partitions[type]);
+                }
+            }
+        }
+        else if (byId && condition.getOp() == ConditionOp::Equal && condition.hasId()) {
+            removedCount = markById(condition.getId(), targets, touched);
+        }
+        else if (!byId && probeCost(condition) < scanCost(types, ConditionExpression::leafCost(condition))
+            && findIndexed(condition, targets)) {
+            ++indexPlans;
+            touched = markFilms(targets);
+            removedCount = targets.size();
+        }
+        else if (condition.getOp() == ConditionOp::Contains
+            && (condition.getField() == ConditionField::Title || condition.getField() == ConditionField::Director)) {
+            ++scanPlans;
+            removedCount = markContaining(condition, types, targets, touched);
+        }
+        else if (condition.getField() == ConditionField::Episodes) {
+            ++scanPlans;
+            removedCount = markEpisodes(condition, targets, touched);
+        }
+        else {
+            checkIdCondition(condition);
+            ++scanPlans;
+            removedCount = markMatching(types, [&](const Partition& partition, size_t position) {
+                return matchesAt(partition, position, condition);
+            }, targets, touched);
+        }
+        return removedCount;
+    });
+}
+
+void FilmContainer::removeFilms(const ConditionExpression& expression) {
+    if (expression.isSingle()) {
+        removeFilms(expression.getSingle());
         return;
     }
+    bool byId = false;
+    for (const Condition& condition : expression.getConditions()) {
+        byId = byId || condition.getField() == ConditionField::Id;
+    }
+    runRemoval(expression.getText(), byId, [&](std::vector<const Film*>& targets, unsigned& touched) {
+        for (const Condition& condition : expression.getConditions()) {
+            checkIdCondition(condition);
+        }
+        unsigned types = expression.candidateTypes(candidateTypes, ALL_TYPES);
+        std::vector<const Film*> candidates;
+        if (hasIndexes() && planExpression(expression, types, candidates)) {
+            // Кандидаты из индекса проверяются полным выражением; повторы отсеиваются по пометке dead
+            ++indexPlans;
+            size_t removedCount = 0;
+            for (const Film* film : candidates) {
+                const Slot& slot = slots[slotOf.at(film)];
+                Partition& partition = partitions[slot.type];
+                size_t position = slot.position;
+                if (!partition.dead[position] && expression.evaluate([&](const Condition& condition) {
+                        return matchesAt(partition, position, condition);
+                    })) {
+                    killFilm(partition, position);
+                    targets.push_back(film);
+                    touched |= 1u << slot.type;
+                    ++removedCount;
+                }
+            }
+            return removedCount;
+        }
+        ++scanPlans;
+        // Один проход по фильмам вместо REM на каждое условие; AND и OR прекращают проверку досрочно
+        return markMatching(types, [&](const Partition& partition, size_t position) {
+            return expression.evaluate([&](const Condition& condition) {
+                return matchesAt(partition, position, condition);
+            });
+        }, targets, touched);
+    });
+}
+
+size_t FilmContainer::markById(FilmId id, std::vector<const Film*>& targets, unsigned& touched) {
+    // Фильм находится по ячейке идентификатора, без просмотра и индексов
+    Partition* partition = nullptr;
+    size_t position = 0;
+    const Film* film = findById(id, partition, position);
+    if (!film) {
+        return 0;
+    }
+    if (hasIndexes()) {
+        targets.push_back(film);
+    }
+    killFilm(*partition, position);
+    touched |= 1u << static_cast<unsigned>(film->getTypeTag());
+    return 1;
+}
+
+bool FilmContainer::removeFilm(FilmId id) {
+    Partition* partition = nullptr;
+    size_t position = 0;
+    if (!findById(id, partition, position)) {
+        *output << "Error: No film with id " << id << '\n';
+        output->flush();
+        return false;
+    }
+    runRemoval(std::string(), true, [&](std::vector<const Film*>& targets, unsigned& touched) {
+        return markById(id, targets, touched);
+    });
+    return true;
+}
+
+void FilmContainer::beginJournalReplay() {
+    replayBase = nextSequence;
+}
+
+bool FilmContainer::removeJournaled(uint64_t ordinal) {
+    // Номера добавления в разделе возрастают, фильм ищется двоичным поиском
+    uint64_t sequence = replayBase + ordinal;
+    for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+        const Partition& partition = partitions[type];
+        auto found = std::lower_bound(partition.sequence.begin(), partition.sequence.end(), sequence);
+        if (found != partition.sequence.end() && *found == sequence) {
+            size_t position = static_cast<size_t>(found - partition.sequence.begin());
+            if (partition.dead[position]) {
+                return false;
+            }
+            runRemoval(std::string(), true, [&](std::vector<const Film*>& targets, unsigned& touched) {
+                return markById(idAt(partition, position), targets, touched);
+            });
+            return true;
+        }
+    }
+    return false;
+}
+
+bool FilmContainer::findCandidates(const ConditionExpression& expression, unsigned types,
+    std::vector<const Film*>& candidates) const {
+    if (!hasIndexes()) {
+        return false;
+    }
+    if (expression.isSingle()) {
+        const Condition& condition = expression.getSingle();
+        return probeCost(condition) < scanCost(types, ConditionExpression::leafCost(condition))
+            && findIndexed(condition, candidates);
+    }
+    return planExpression(expression, types, candidates);
+}
+
+template <typename Visit>
+size_t FilmContainer::visitMatching(const ConditionExpression& expression, size_t limit, bool ordered, Visit visit) const {
+    for (const Condition& condition : expression.getConditions()) {
+        checkIdCondition(condition);
+    }
+    if (limit == 0) {
+        return 0;
+    }
+    unsigned types = expression.candidateTypes(candidateTypes, ALL_TYPES);
+    auto matches = [&](const Partition& partition, size_t position) {
+        return expression.evaluate([&](const Condition& condition) {
+            return matchesAt(partition, position, condition);
+        });
+    };
 
-    std::cout << "Films in container (" << films.size() << " total):" << std::endl;
-    for (size_t i = 0; i < films.size(); ++i) {
-        std::cout << i + 1 << ". ";
-        films[i]->print();
+    size_t found = 0;
+    std::vector<const Film*> candidates;
+    if (findCandidates(expression, types, candidates)) {
+        // Кандидаты индекса упорядочиваются по номеру добавления, повторы из OR отбрасываются
+        ++indexPlans;
+        std::vector<std::pair<uint64_t, uint32_t>> matched;
+        for (const Film* film : candidates) {
+            uint32_t index = slotOf.at(film);
+            const Partition& partition = partitions[slots[index].type];
+            size_t position = slots[index].position;
+            if (matches(partition, position)) {
+                matched.emplace_back(partition.sequence[position], index);
+            }
+        }
+        std::sort(matched.begin(), matched.end());
+        matched.erase(std::unique(matched.begin(), matched.end()), matched.end());
+        for (size_t i = 0; i < matched.size() && found < limit; ++i) {
+            const Slot& slot = slots[matched[i].second];
+            visit(partitions[slot.type], slot.position);
+            ++found;
+        }
+        return found;
+    }
+
+    ++scanPlans;
+    if (ordered) {
+        visitOrdered(types, [&](const Partition& partition, size_t position) {
+            if (!matches(partition, position)) {
+                return true;
+            }
+            visit(partition, position);
+            return ++found < limit;
+        });
+        return found;
     }
+    for (size_t type = 0; type < FILM_TYPE_COUNT && found < limit; ++type) {
+        const Partition& partition = partitions[type];
+        if (!(types & (1u << type))) {
+            continue;
+        }
+        for (size_t i = 0; i < partition.films.size() && found < limit; ++i) {
+            if (!partition.dead[i] && matches(partition, i)) {
+                visit(partition, i);
+                ++found;
+            }
+        }
+    }
+    return found;
+}
+
+size_t FilmContainer::findFilms(const std::string& condition, size_t limit) const {
+    if (condition.empty()) {
+        *output << "Error: Empty condition provided\n";
+        output->flush();
+        return 0;
+    }
+    return findFilms(ConditionExpression::compile(condition), limit);
+}
+
+size_t FilmContainer::findFilms(const ConditionExpression& expression, size_t limit) const {
+    size_t found = 0;
+    try {
+        // Фильмы выводятся по мере нахождения, без промежуточной копии
+        size_t number = 0;
+        found = visitMatching(expression, limit, true, [&](const Partition& partition, size_t position) {
+            *output << ++number << ". ";
+            partition.films[position]->print(*output);
+        });
+        *output << "Found " << found << " film(s)\n";
+    }
+    catch (const std::exception& e) {
+        *output << "Error finding films: " << e.what() << '\n';
+    }
+    output->flush();
+    return found;
+}
+
+size_t FilmContainer::countFilms(const std::string& condition) const {
+    if (condition.empty()) {
+        *output << "Error: Empty condition provided\n";
+        output->flush();
+        return 0;
+    }
+    return countFilms(ConditionExpression::compile(condition));
+}
+
+size_t FilmContainer::countFilms(const ConditionExpression& expression) const {
+    size_t counted = 0;
+    try {
+        counted = visitMatching(expression, SIZE_MAX, false, [](const Partition&, size_t) {});
+        *output << "Counted " << counted << " film(s)\n";
+    }
+    catch (const std::exception& e) {
+        *output << "Error counting films: " << e.what() << '\n';
+    }
+    output->flush();
+    return counted;
+}
+
+void FilmContainer::printAll(bool showIds) const {
+    if (size() == 0) {
+        *output << "Container is empty\n";
+        output->flush();
+        return;
+    }
+
+    *output << "Films in container (" << size() << " total):\n";
+    size_t number = 0;
+    visitOrdered(ALL_TYPES, [&](const Partition& partition, size_t position) {
+        *output << ++number << ". ";
+        if (showIds) {
+            *output << "[id " << idAt(partition, position) << "] ";
+        }
+        partition.films[position]->print(*output);
+        return true;
+    });
+    output->flush();
 }
 
 size_t FilmContainer::size() const {
-    return films.size();
+    size_t total = 0;
+    for (const Partition& partition : partitions) {
+        total += partition.liveCount();
+    }
+    return total;
+}
+
+void FilmContainer::setCompactionThreshold(double fraction) {
+    compactionThreshold = std::clamp(fraction, 0.0, 1.0);
+    for (Partition& partition : partitions) {
+        compactIfNeeded(partition);
+    }
+}
+
+const FilmStatistics* FilmContainer::getStatistics() const {
+    return statistics.get();
+}
+
+size_t FilmContainer::getIndexPlanCount() const {
+    return indexPlans;
+}
+
+size_t FilmContainer::getScanPlanCount() const {
+    return scanPlans;
+}
+
+void FilmContainer::setRemovalThreads(unsigned threads) {
+    removalPool.reset();
+    auto pool = std::make_unique<ThreadPool>(threads);
+    if (pool->size() > 1) {
+        removalPool = std::move(pool);
+    }
+}
+
+unsigned FilmContainer::getRemovalThreads() const {
+    return removalPool ? removalPool->size() : 1;
+}
+
+void FilmContainer::setParallelRemovalThreshold(size_t films) {
+    parallelRemovalThreshold = films;
+}
+
+size_t FilmContainer::getTombstoneCount() const {
+    size_t total = 0;
+    for (const Partition& partition : partitions) {
+        total += partition.deadCount;
+    }
+    return total;
+}
+
+bool FilmContainer::saveSnapshot(const std::string& filename) const {
+    std::string error;
+    std::vector<const Film*> ordered = orderedFilms();
+    bool saved = writeFilmSnapshot(filename, ordered, error);
+    if (saved) {
+        *output << "Snapshot saved: " << ordered.size() << " film(s) to '" << filename << "'\n";
+    }
+    else {
+        *output << "Error: " << error << '\n';
+    }
+    output->flush();
+    return saved;
+}
+
+bool FilmContainer::loadSnapshot(const std::string& filename) {
+    std::string error;
+    std::vector<FilmValue> loadedFilms;
+    bool loaded = readFilmSnapshot(filename, loadedFilms, error);
+    if (loaded) {
+        clearFilms();
+        rebuildIndexes();
+        std::array<size_t, FILM_TYPE_COUNT> counts{};
+        for (const FilmValue& film : loadedFilms) {
+            ++counts[static_cast<size_t>(asFilm(film).getTypeTag())];
+        }
+        reservePartitions(counts);
+        for (FilmValue& film : loadedFilms) {
+            place(allocateFilm(std::move(film), *resource));
+        }
+        *output << "Snapshot loaded: " << size() << " film(s) from '" << filename << "'\n";
+        if (journal) {
+            compactJournal();
+        }
+    }
+    else {
+        *output << "Error: " << error << '\n';
+    }
+    output->flush();
+    return loaded;
+}
+
+void FilmContainer::renumberFilms() {
+    // После переписи журнала номер добавления фильма совпадает с номером его записи ADD: на них ссылается DEL
+    for (Partition& partition : partitions) {
+        if (partition.deadCount > 0) {
+            partition.compact(slots);
+        }
+    }
+    std::array<size_t, FILM_TYPE_COUNT> next{};
+    uint64_t sequence = 0;
+    while (true) {
+        size_t best = FILM_TYPE_COUNT;
+        for (size_t type = 0; type < FILM_TYPE_COUNT; ++type) {
+            const Partition& partition = partitions[type];
+            if (next[type] < partition.films.size()
+                && (best == FILM_TYPE_COUNT || partition.sequence[next[type]] < partitions[best].sequence[next[best]])) {
+                best = type;
+            }
+        }
+        if (best == FILM_TYPE_COUNT) {
+            break;
+        }
+        partitions[best].sequence[next[best]++] = sequence++;
+    }
+    nextSequence = sequence;
+}
+
+bool FilmContainer::attachJournal(const std::string& filename) {
+    auto opened = std::make_unique<FilmJournal>(filename);
+    std::string error;
+    if (!opened->isOpen()) {
+        *output << "Error: Cannot open journal file '" << filename << "'\n";
+        output->flush();
+        return false;
+    }
+    if (!opened->compact(orderedFilms(), error)) {
+        *output << "Error: " << error << '\n';
+        output->flush();
+        return false;
+    }
+    opened->setGroupCommit(journalGroupCommit);
+    journal = std::move(opened);
+    renumberFilms();
+    *output << "Journal attached: '" << filename << "' (" << size() << " film(s))\n";
+    output->flush();
+    return true;
+}
+
+void FilmContainer::setJournalGroupCommit(size_t mutations) {
+    journalGroupCommit = mutations;
+    if (journal) {
+        journal->setGroupCommit(mutations);
+    }
+}
+
+void FilmContainer::detachJournal() {
+    journal.reset();
+}
+
+bool FilmContainer::compactJournal() {
+    if (!journal) {
+        *output << "Error: No journal attached\n";
+        output->flush();
+        return false;
+    }
+    std::string error;
+    size_t before = journal->getRecordCount();
+    if (!journal->compact(orderedFilms(), error)) {
+        *output << "Error: " << error << '\n';
+        output->flush();
+        return false;
+    }
+    renumberFilms();
+    *output << "Journal compacted: " << before << " -> " << journal->getRecordCount() << " record(s)\n";
+    output->flush();
+    return true;
+}
+
+void FilmContainer::setTitleIndex(bool enabled) {
+    if (!enabled) {
+        titleIndex.reset();
+        if (!hasIndexes()) {
+            slotOf.clear();
+            statistics.reset();
+        }
+        return;
+    }
+    if (!titleIndex) {
+        titleIndex = std::make_unique<FilmStringIndex>(filmTitle);
+        rebuildIndexes();
+    }
+}
+
+bool FilmContainer::hasTitleIndex() const {
+    return titleIndex != nullptr;
+}
+
+void FilmContainer::setDirectorIndex(bool enabled) {
+    if (!enabled) {
+        directorIndex.reset();
+        if (!hasIndexes()) {
+            slotOf.clear();
+            statistics.reset();
+        }
+        return;
+    }
+    if (!directorIndex) {
+        directorIndex = std::make_unique<FilmStringIndex>(filmDirector);
+        rebuildIndexes();
+    }
+}
+
+bool FilmContainer::hasDirectorIndex() const {
+    return directorIndex != nullptr;
+}
+
+void FilmContainer::setEpisodeIndex(bool enabled) {
+    if (!enabled) {
+        episodeIndex.reset();
+        if (!hasIndexes()) {
+            slotOf.clear();
+            statistics.reset();
+        }
+        return;
+    }
+    if (!episodeIndex) {
+        episodeIndex = std::make_unique<EpisodeIndex>();
+        rebuildIndexes();
+    }
+}
+
+bool FilmContainer::hasEpisodeIndex() const {
+    return episodeIndex != nullptr;
+}
+
+void FilmContainer::setTrigramIndex(bool enabled) {
+    if (!enabled) {
+        titleTrigrams.reset();
+        directorTrigrams.reset();
+        if (!hasIndexes()) {
+            slotOf.clear();
+            statistics.reset();
+        }
+        return;
+    }
+    if (!titleTrigrams) {
+        titleTrigrams = std::make_unique<TrigramIndex>(filmTitle);
+        directorTrigrams = std::make_unique<TrigramIndex>(filmDirector);
+        rebuildIndexes();
+    }
+}
+
+bool FilmContainer::hasTrigramIndex() const {
+    return titleTrigrams != nullptr;
 }
 
-bool FilmContainer::validateAddCommand(const std::string& type, const std::vector<std::string>& params) {
+bool FilmContainer::validateAddCommand(const std::string& type, const std::vector<std::string>& params, OutputSink& output) {
     if (type == "cartoon") {
         if (params.size() < 2) {
-            std::cout << "Error: Cartoon film requires title and animation type (drawn/puppet/plasticine)" << std::endl;
+            output << "Error: Cartoon film requires title and animation type (drawn/puppet/plasticine)\n";
             return false;
         }
         if (params[1] != "drawn" && params[1] != "puppet" && params[1] != "plasticine") {
-            std::cout << "Error: Invalid animation type. Use: drawn, puppet, or plasticine" << std::endl;
+            output << "Error: Invalid animation type. Use: drawn, puppet, or plasticine\n";
             return false;
         }
     }
     else if (type == "game") {
         if (params.size() < 2) {
-            std::cout << "Error: Game film requires title and director" << std::endl;
+            output << "Error: Game film requires title and director\n";
             return false;
         }
     }
     else if (type == "series") {
         if (params.size() < 3) {
-            std::cout << "Error: Series film requires title, director, and episode count" << std::endl;
+            output << "Error: Series film requires title, director, and episode count\n";
             return false;
         }
         try {
             int episodes = std::stoi(params[2]);
             if (episodes <= 0) {
-                std::cout << "Error: Episode count must be positive" << std::endl;
+                output << "Error: Episode count must be positive\n";
                 return false;
             }
         }
         catch (...) {
-            std::cout << "Error: Invalid episode count '" << params[2] << "'. Must be a number" << std::endl;
+            output << "Error: Invalid episode count '" << params[2] << "'. Must be a number\n";
             return false;
         }
     }
     else {
-        std::cout << "Error: Unknown film type '" << type << "'. Use: cartoon, game, or series" << std::endl;
+        output << "Error: Unknown film type '" << type << "'. Use: cartoon, game, or series\n";
         return false;
     }
     return true;
@@ -1,17 +1,198 @@
 #pragma once
 #include "Film.h"
+#include "FilmValue.h"
+#include "Condition.h"
+#include "ConditionExpression.h"
+#include "StringSearch.h"
+#include "NumberFilter.h"
+#include <array>
+#include <cstdint>
+#include <functional>
 #include <memory>
+#include <memory_resource>
+#include <unordered_map>
 #include <vector>
 
+class FilmJournal;
+class ThreadPool;
+class FilmStringIndex;
+class EpisodeIndex;
+class TrigramIndex;
+class FilmStatistics;
+
+// Устойчивый идентификатор фильма: номер ячейки в младших 32 битах, ее поколение в старших
+using FilmId = uint64_t;
+constexpr FilmId INVALID_FILM_ID = ~FilmId(0);
+
 class FilmContainer {
 private:
-    std::vector<std::unique_ptr<Film>> films;
+    // Ячейка идентификатора: где лежит фильм; поколение растет при каждом освобождении
+    struct Slot
+    {
+        uint32_t generation = 0;
+        uint32_t type = 0;
+        size_t position = 0;
+    };
+
+    // Фильмы одного типа в порядке добавления; номера sequence задают общий порядок для PRINT.
+    // Удаленные фильмы помечаются в dead и остаются на месте до уплотнения раздела.
+    // Число серий лежит отдельным столбцом для пакетной проверки episodes; у остальных типов там 0
+    struct Partition
+    {
+        std::vector<uint64_t> sequence;
+        std::vector<FilmPtr> films;
+        std::vector<int> episodes;
+        std::vector<uint32_t> slot;
+        std::vector<bool> dead;
+        size_t deadCount = 0;
+        // Склеенные названия и режиссеры для пакетного contains: строка i принадлежит фильму i,
+        // удаленные остаются до уплотнения; новые фильмы дописываются при следующем поиске
+        BatchSearch titles;
+        BatchSearch directors;
+
+        size_t liveCount() const;
+        void compact(std::vector<Slot>& slots);
+        void clear();
+    };
+
+    std::array<Partition, FILM_TYPE_COUNT> partitions;
+    uint64_t nextSequence = 0;
+    double compactionThreshold = 0.0;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    // Ячейка каждого живого фильма, пока включен хотя бы один индекс
+    std::unordered_map<const Film*, uint32_t> slotOf;
+    OutputSink* output;
+    std::pmr::memory_resource* resource;
+    std::unique_ptr<FilmJournal> journal;
+    size_t journalGroupCommit = 1;
+    // Номера добавления фильмов, удаленных текущим REM по id: в журнал они пишутся записями DEL
+    bool collectRemoved = false;
+    std::vector<uint64_t> removedSequences;
+    // Номер добавления первого фильма воспроизводимого журнала
+    uint64_t replayBase = 0;
+    std::unique_ptr<FilmStringIndex> titleIndex;
+    std::unique_ptr<FilmStringIndex> directorIndex;
+    std::unique_ptr<EpisodeIndex> episodeIndex;
+    std::unique_ptr<TrigramIndex> titleTrigrams;
+    std::unique_ptr<TrigramIndex> directorTrigrams;
+    // Ведется вместе с индексами; по ней выбирается путь доступа для REM
+    std::unique_ptr<FilmStatistics> statistics;
+    // Карта отбора сериалов по episodes
+    std::vector<uint64_t> selection;
+    // Потоки для проверки условия при просмотре в REM; без пула проверка последовательная
+    std::unique_ptr<ThreadPool> removalPool;
+    size_t parallelRemovalThreshold;
+    std::vector<unsigned char> removalHits;
+    mutable size_t indexPlans = 0;
+    mutable size_t scanPlans = 0;
+
+    FilmId place(FilmPtr film);
+    template <typename Visit>
+    void visitOrdered(unsigned types, Visit visit) const;
+    std::vector<const Film*> orderedFilms() const;
+    void killFilm(Partition& partition, size_t position);
+    void releaseSlot(uint32_t index);
+    void reservePartitions(const std::array<size_t, FILM_TYPE_COUNT>& counts);
+    void clearFilms();
+    void indexFilm(const Film& film, uint32_t slot);
+    void unindexFilms(const std::vector<const Film*>& removed);
+    bool hasIndexes() const;
+    void rebuildIndexes();
+    bool findIndexed(const Condition& condition, std::vector<const Film*>& targets) const;
+    double probeCost(const Condition& condition) const;
+    double scanCost(unsigned types, unsigned filmCost) const;
+    bool planExpression(const ConditionExpression& expression, unsigned types, std::vector<const Film*>& candidates) const;
+    bool findCandidates(const ConditionExpression& expression, unsigned types, std::vector<const Film*>& candidates) const;
+    template <typename Visit>
+    size_t visitMatching(const ConditionExpression& expression, size_t limit, bool ordered, Visit visit) const;
+    unsigned markFilms(const std::vector<const Film*>& targets);
+    const Film* findById(FilmId id, Partition*& partition, size_t& position);
+    FilmId idAt(const Partition& partition, size_t position) const;
+    size_t markById(FilmId id, std::vector<const Film*>& targets, unsigned& touched);
+    void renumberFilms();
+    bool matchesAt(const Partition& partition, size_t position, const Condition& condition) const;
+    static void checkIdCondition(const Condition& condition);
+    size_t markContaining(const Condition& condition, unsigned types, std::vector<const Film*>& targets, unsigned& touched);
+    size_t markEpisodes(const Condition& condition, std::vector<const Film*>& targets, unsigned& touched);
+    template <typename Predicate>
+    size_t markMatching(unsigned types, Predicate matches, std::vector<const Film*>& targets, unsigned& touched);
+    void runRemoval(const std::string& text, bool byId,
+        const std::function<size_t(std::vector<const Film*>&, unsigned&)>& mark);
+    size_t dropPartition(Partition& partition);
+    void compactIfNeeded(Partition& partition);
+    static unsigned candidateTypes(const Condition& condition);
+    void reportBatch(size_t added, size_t rejected) const;
 
 public:
-    void addFilm(std::unique_ptr<Film> film);
+    // Фильмы, добавленные по значению, создаются в resource; он должен жить дольше контейнера
+    explicit FilmContainer(OutputSink& output = standardOutput(),
+        std::pmr::memory_resource* resource = std::pmr::new_delete_resource());
+    ~FilmContainer();
+
+    void setOutput(OutputSink& output);
+    OutputSink& getOutput() const;
+
+    // Возвращают идентификатор, по которому фильм удаляется за O(1); INVALID_FILM_ID при ошибке
+    FilmId addFilm(std::unique_ptr<Film> film);
+    void addFilms(std::vector<std::unique_ptr<Film>> batch);
+    FilmId addFilm(FilmValue film);
+    void addFilms(std::vector<FilmValue> batch);
+    void addFilms(size_t count, const std::function<std::unique_ptr<Film>(size_t)>& generator);
     void removeFilms(const std::string& condition);
-    void printAll() const;
+    void removeFilms(const Condition& condition);
+    // AND, OR, NOT и скобки: все условия проверяются за один проход по фильмам
+    void removeFilms(const ConditionExpression& expression);
+    bool removeFilm(FilmId id);
+    // Не меняют контейнер: FIND выводит совпадения в порядке добавления и останавливается на limit,
+    // COUNT только считает их
+    size_t findFilms(const std::string& condition, size_t limit = SIZE_MAX) const;
+    size_t findFilms(const ConditionExpression& expression, size_t limit = SIZE_MAX) const;
+    size_t countFilms(const std::string& condition) const;
+    size_t countFilms(const ConditionExpression& expression) const;
+    void printAll(bool showIds = false) const;
     size_t size() const;
-    static bool validateAddCommand(const std::string& type, const std::vector<std::string>& params);
+
+    // Доля удаленных фильмов в разделе, после которой он уплотняется; 0 - уплотнять сразу
+    void setCompactionThreshold(double fraction);
+    size_t getTombstoneCount() const;
+
+    // Потоки для REM с просмотром: условие проверяется кусками параллельно, а удаление идет по порядку,
+    // поэтому результат и идентификаторы те же, что без потоков. 0 - по числу ядер, 1 - без потоков.
+    // Разделы меньше threshold фильмов проверяются последовательно
+    void setRemovalThreads(unsigned threads);
+    unsigned getRemovalThreads() const;
+    void setParallelRemovalThreshold(size_t films);
+
+    bool saveSnapshot(const std::string& filename) const;
+    bool loadSnapshot(const std::string& filename);
+
+    bool attachJournal(const std::string& filename);
+    void detachJournal();
+    bool compactJournal();
+    // Сколько изменений копится до записи журнала в файл; 1 - каждое изменение записывается сразу
+    void setJournalGroupCommit(size_t mutations);
+    // Удаление по id пишется в журнал как DEL n, где n - номер записи ADD в журнале. При воспроизведении
+    // номера отсчитываются от фильма, добавленного первым после beginJournalReplay
+    void beginJournalReplay();
+    bool removeJournaled(uint64_t ordinal);
+
+    // Индексы ускоряют REM по равенству, сравнения episodes и contains; на вывод не влияют
+    void setTitleIndex(bool enabled);
+    bool hasTitleIndex() const;
+    void setDirectorIndex(bool enabled);
+    bool hasDirectorIndex() const;
+    void setEpisodeIndex(bool enabled);
+    bool hasEpisodeIndex() const;
+    void setTrigramIndex(bool enabled);
+    bool hasTrigramIndex() const;
+
+    // Статистика есть, только пока включен хотя бы один индекс
+    const FilmStatistics* getStatistics() const;
+    size_t getIndexPlanCount() const;
+    size_t getScanPlanCount() const;
+
+    static bool validateAddCommand(const std::string& type, const std::vector<std::string>& params,
+        OutputSink& output = standardOutput());
 };
 
@@ -0,0 +1,372 @@
+#include "FilmIndex.h"
+#include "GameFilm.h"
+#include "SeriesFilm.h"
+#include <algorithm>
+
+const std::string* filmTitle(const Film& film) {
+    return &film.getTitle();
+}
+
+const std::string* filmDirector(const Film& film) {
+    switch (film.getTypeTag()) {
+    case FilmType::Game: return &static_cast<const GameFilm&>(film).getDirector();
+    case FilmType::Series: return &static_cast<const SeriesFilm&>(film).getDirector();
+    default: return nullptr;
+    }
+}
+
+FilmStringIndex::FilmStringIndex(FilmKeyFunction key) : key(key) {}
+
+void FilmStringIndex::insert(const Film& film) {
+    if (const std::string* value = key(film)) {
+        std::vector<const Film*>& films = entries[*value];
+        positions[&film] = films.size();
+        films.push_back(&film);
+    }
+}
+
+void FilmStringIndex::erase(const std::vector<const Film*>& films) {
+    for (const Film* film : films) {
+        const std::string* value = key(*film);
+        auto position = positions.find(film);
+        if (!value || position == positions.end()) {
+            continue;
+        }
+        // На место удаляемого встает последний фильм того же значения
+        auto bucket = entries.find(*value);
+        std::vector<const Film*>& list = bucket->second;
+        const Film* last = list.back();
+        list[position->second] = last;
+        positions[last] = position->second;
+        list.pop_back();
+        positions.erase(position);
+        if (list.empty()) {
+            entries.erase(bucket);
+        }
+    }
+}
+
+void FilmStringIndex::clear() {
+    entries.clear();
+    positions.clear();
+}
+
+void FilmStringIndex::rebuild(const std::vector<const Film*>& films) {
+    clear();
+    positions.reserve(films.size());
+    for (const auto& film : films) {
+        insert(*film);
+    }
+}
+
+std::vector<const Film*> FilmStringIndex::find(std::string_view value) const {
+    auto it = entries.find(value);
+    if (it == entries.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+size_t FilmStringIndex::count(std::string_view value) const {
+    auto it = entries.find(value);
+    return it == entries.end() ? 0 : it->second.size();
+}
+
+size_t FilmStringIndex::size() const {
+    return positions.size();
+}
+
+static bool episodeCount(const Film& film, int& episodes) {
+    if (film.getTypeTag() != FilmType::Series) {
+        return false;
+    }
+    episodes = static_cast<const SeriesFilm&>(film).getEpisode();
+    return true;
+}
+
+void EpisodeIndex::insert(const Film& film) {
+    int episodes;
+    if (episodeCount(film, episodes)) {
+        handles[&film] = entries.emplace(episodes, &film);
+    }
+}
+
+void EpisodeIndex::erase(const std::vector<const Film*>& films) {
+    for (const Film* film : films) {
+        auto handle = handles.find(film);
+        if (handle == handles.end()) {
+            continue;
+        }
+        entries.erase(handle->second);
+        handles.erase(handle);
+    }
+}
+
+void EpisodeIndex::clear() {
+    entries.clear();
+    handles.clear();
+}
+
+void EpisodeIndex::rebuild(const std::vector<const Film*>& films) {
+    clear();
+    handles.reserve(films.size());
+    for (const auto& film : films) {
+        insert(*film);
+    }
+}
+
+std::vector<const Film*> EpisodeIndex::find(const Condition& condition) const {
+    std::vector<const Film*> result;
+    if (!condition.hasNumber()) {
+        return result;
+    }
+    int number = condition.getNumber();
+    auto append = [&result](auto first, auto last) {
+        for (; first != last; ++first) {
+            result.push_back(first->second);
+        }
+    };
+    switch (condition.getOp()) {
+    case ConditionOp::Equal: append(entries.lower_bound(number), entries.upper_bound(number)); break;
+    case ConditionOp::NotEqual:
+        append(entries.begin(), entries.lower_bound(number));
+        append(entries.upper_bound(number), entries.end());
+        break;
+    case ConditionOp::Greater: append(entries.upper_bound(number), entries.end()); break;
+    case ConditionOp::GreaterEqual: append(entries.lower_bound(number), entries.end()); break;
+    case ConditionOp::Less: append(entries.begin(), entries.lower_bound(number)); break;
+    case ConditionOp::LessEqual: append(entries.begin(), entries.upper_bound(number)); break;
+    default: break;
+    }
+    return result;
+}
+
+size_t EpisodeIndex::size() const {
+    return entries.size();
+}
+
+static void collectTrigrams(std::string_view text, std::vector<uint32_t>& grams) {
+    grams.clear();
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        grams.push_back(static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16
+            | static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8
+            | static_cast<unsigned char>(text[i + 2]));
+    }
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+}
+
+TrigramIndex::TrigramIndex(FilmKeyFunction key) : key(key) {}
+
+bool TrigramIndex::isLive(const Posting& posting) const {
+    auto it = live.find(posting.film);
+    return it != live.end() && it->second == posting.stamp;
+}
+
+void TrigramIndex::purge() {
+    for (auto it = postings.begin(); it != postings.end();) {
+        std::vector<Posting>& list = it->second;
+        list.erase(std::remove_if(list.begin(), list.end(),
+            [this](const Posting& posting) { return !isLive(posting); }), list.end());
+        if (list.empty()) {
+            it = postings.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+    postingCount -= staleCount;
+    staleCount = 0;
+}
+
+void TrigramIndex::insert(const Film& film) {
+    const std::string* value = key(film);
+    if (!value) {
+        return;
+    }
+    // После переполнения метки старые записи могли бы совпасть с новыми, поэтому сначала чистим их
+    if (++nextStamp == 0) {
+        purge();
+    }
+    live[&film] = nextStamp;
+    collectTrigrams(*value, grams);
+    for (uint32_t gram : grams) {
+        postings[gram].push_back({&film, nextStamp});
+    }
+    postingCount += grams.size();
+}
+
+void TrigramIndex::erase(const std::vector<const Film*>& films) {
+    for (const Film* film : films) {
+        const std::string* value = key(*film);
+        if (!value || live.erase(film) == 0) {
+            continue;
+        }
+        collectTrigrams(*value, grams);
+        staleCount += grams.size();
+    }
+    if (staleCount > postingCount / 2) {
+        purge();
+    }
+}
+
+void TrigramIndex::clear() {
+    postings.clear();
+    live.clear();
+    postingCount = 0;
+    staleCount = 0;
+}
+
+void TrigramIndex::rebuild(const std::vector<const Film*>& films) {
+    clear();
+    for (const auto& film : films) {
+        insert(*film);
+    }
+}
+
+bool TrigramIndex::find(std::string_view value, std::vector<const Film*>& result) const {
+    result.clear();
+    std::vector<uint32_t> queryGrams;
+    collectTrigrams(value, queryGrams);
+    if (queryGrams.empty()) {
+        return false;
+    }
+
+    // Кандидаты берутся из самого короткого списка и проверяются по полной строке
+    const std::vector<Posting>* shortest = shortestPostings(queryGrams);
+    if (!shortest) {
+        return true;
+    }
+    for (const Posting& posting : *shortest) {
+        if (isLive(posting) && key(*posting.film)->find(value) != std::string::npos) {
+            result.push_back(posting.film);
+        }
+    }
+    return true;
+}
+
+const std::vector<TrigramIndex::Posting>* TrigramIndex::shortestPostings(const std::vector<uint32_t>& queryGrams) const {
+    // nullptr, если какой-то триграммы нет ни у одного фильма
+    const std::vector<Posting>* shortest = nullptr;
+    for (uint32_t gram : queryGrams) {
+        auto it = postings.find(gram);
+        if (it == postings.end()) {
+            return nullptr;
+        }
+        if (!shortest || it->second.size() < shortest->size()) {
+            shortest = &it->second;
+        }
+    }
+    return shortest;
+}
+
+size_t TrigramIndex::estimate(std::string_view value) const {
+    std::vector<uint32_t> queryGrams;
+    collectTrigrams(value, queryGrams);
+    if (queryGrams.empty()) {
+        return SIZE_MAX;
+    }
+    const std::vector<Posting>* shortest = shortestPostings(queryGrams);
+    return shortest ? shortest->size() : 0;
+}
+
+size_t TrigramIndex::size() const {
+    return live.size();
+}
+
+size_t FilmStatistics::bucketOf(int episodes) {
+    size_t bucket = 0;
+    while (episodes > 1 && bucket + 1 < EPISODE_BUCKETS) {
+        episodes >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+void FilmStatistics::insert(const Film& film) {
+    ++typeCounts[static_cast<size_t>(film.getTypeTag())];
+    if (const std::string* director = filmDirector(film)) {
+        ++directorCounts[*director];
+    }
+    if (film.getTypeTag() == FilmType::Series) {
+        ++episodeBuckets[bucketOf(static_cast<const SeriesFilm&>(film).getEpisode())];
+    }
+}
+
+void FilmStatistics::erase(const std::vector<const Film*>& films) {
+    for (const Film* film : films) {
+        --typeCounts[static_cast<size_t>(film->getTypeTag())];
+        if (const std::string* director = filmDirector(*film)) {
+            auto it = directorCounts.find(*director);
+            if (--it->second == 0) {
+                directorCounts.erase(it);
+            }
+        }
+        if (film->getTypeTag() == FilmType::Series) {
+            --episodeBuckets[bucketOf(static_cast<const SeriesFilm*>(film)->getEpisode())];
+        }
+    }
+}
+
+void FilmStatistics::clear() {
+    typeCounts.fill(0);
+    directorCounts.clear();
+    episodeBuckets.fill(0);
+}
+
+void FilmStatistics::rebuild(const std::vector<const Film*>& films) {
+    clear();
+    for (const Film* film : films) {
+        insert(*film);
+    }
+}
+
+size_t FilmStatistics::getTypeCount(FilmType type) const {
+    return typeCounts[static_cast<size_t>(type)];
+}
+
+size_t FilmStatistics::getDistinctDirectors() const {
+    return directorCounts.size();
+}
+
+size_t FilmStatistics::countDirector(std::string_view director) const {
+    auto it = directorCounts.find(director);
+    return it == directorCounts.end() ? 0 : it->second;
+}
+
+double FilmStatistics::countEpisodesBelow(int64_t bound) const {
+    double count = 0;
+    for (size_t bucket = 0; bucket < EPISODE_BUCKETS; ++bucket) {
+        int64_t low = int64_t(1) << bucket;
+        int64_t high = (low << 1) - 1;
+        if (bound > high) {
+            count += episodeBuckets[bucket];
+        }
+        else {
+            if (bound > low) {
+                count += episodeBuckets[bucket] * double(bound - low) / double(high - low + 1);
+            }
+            break;
+        }
+    }
+    return count;
+}
+
+double FilmStatistics::estimateEpisodes(const Condition& condition) const {
+    if (!condition.hasNumber()) {
+        return 0;
+    }
+    int64_t value = condition.getNumber();
+    double total = static_cast<double>(typeCounts[static_cast<size_t>(FilmType::Series)]);
+    double less = countEpisodesBelow(value);
+    double lessEqual = countEpisodesBelow(value + 1);
+    switch (condition.getOp()) {
+    case ConditionOp::Equal: return lessEqual - less;
+    case ConditionOp::NotEqual: return total - (lessEqual - less);
+    case ConditionOp::Greater: return total - lessEqual;
+    case ConditionOp::Less: return less;
+    case ConditionOp::GreaterEqual: return total - less;
+    case ConditionOp::LessEqual: return lessEqual;
+    default: return 0;
+    }
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "Film.h"
+#include "Condition.h"
+#include <array>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Ключ индекса для фильма; nullptr, если у фильма нет такого поля
+using FilmKeyFunction = const std::string* (*)(const Film& film);
+
+const std::string* filmTitle(const Film& film);
+const std::string* filmDirector(const Film& film);
+
+// Хеш-индекс по строковому полю; ключи ссылаются на строки самих фильмов, поэтому фильм должен жить дольше записи.
+// Позиция фильма в списке своего значения позволяет удалить его за O(1), сколько бы фильмов ни было у значения
+class FilmStringIndex
+{
+private:
+	FilmKeyFunction key;
+	std::unordered_map<std::string_view, std::vector<const Film*>> entries;
+	std::unordered_map<const Film*, size_t> positions;
+
+public:
+	explicit FilmStringIndex(FilmKeyFunction key);
+
+	void insert(const Film& film);
+	void erase(const std::vector<const Film*>& films);
+	void clear();
+	void rebuild(const std::vector<const Film*>& films);
+
+	std::vector<const Film*> find(std::string_view value) const;
+	size_t count(std::string_view value) const;
+	size_t size() const;
+};
+
+// Упорядоченный индекс по числу эпизодов сериалов; диапазонные условия находятся двоичным поиском.
+// Итераторы multimap не меняются при других вставках и удалениях, поэтому фильм удаляется по сохраненному итератору
+class EpisodeIndex
+{
+private:
+	std::multimap<int, const Film*> entries;
+	std::unordered_map<const Film*, std::multimap<int, const Film*>::iterator> handles;
+
+public:
+	void insert(const Film& film);
+	void erase(const std::vector<const Film*>& films);
+	void clear();
+	void rebuild(const std::vector<const Film*>& films);
+
+	std::vector<const Film*> find(const Condition& condition) const;
+	size_t size() const;
+};
+
+// Инвертированный индекс триграмм для contains; удаление ленивое, устаревшие записи отсеиваются по метке
+class TrigramIndex
+{
+private:
+	struct Posting
+	{
+		const Film* film;
+		uint32_t stamp;
+	};
+
+	FilmKeyFunction key;
+	std::unordered_map<uint32_t, std::vector<Posting>> postings;
+	std::unordered_map<const Film*, uint32_t> live;
+	uint32_t nextStamp = 0;
+	size_t postingCount = 0;
+	size_t staleCount = 0;
+	std::vector<uint32_t> grams;
+
+	bool isLive(const Posting& posting) const;
+	void purge();
+	const std::vector<Posting>* shortestPostings(const std::vector<uint32_t>& queryGrams) const;
+
+public:
+	explicit TrigramIndex(FilmKeyFunction key);
+
+	void insert(const Film& film);
+	void erase(const std::vector<const Film*>& films);
+	void clear();
+	void rebuild(const std::vector<const Film*>& films);
+
+	// false, если подстрока короче триграммы и индекс не может сузить поиск
+	bool find(std::string_view value, std::vector<const Film*>& result) const;
+	// Верхняя оценка числа кандидатов для find; SIZE_MAX, если подстрока короче триграммы
+	size_t estimate(std::string_view value) const;
+	size_t size() const;
+};
+
+// Статистика для выбора между просмотром и индексом: фильмы по типам, режиссеры, гистограмма эпизодов
+class FilmStatistics
+{
+private:
+	static constexpr size_t EPISODE_BUCKETS = 32;
+
+	std::array<size_t, FILM_TYPE_COUNT> typeCounts{};
+	std::unordered_map<std::string_view, size_t> directorCounts;
+	// Корзина b хранит сериалы с числом эпизодов от 2^b до 2^(b+1) - 1
+	std::array<size_t, EPISODE_BUCKETS> episodeBuckets{};
+
+	static size_t bucketOf(int episodes);
+	double countEpisodesBelow(int64_t bound) const;
+
+public:
+	void insert(const Film& film);
+	void erase(const std::vector<const Film*>& films);
+	void clear();
+	void rebuild(const std::vector<const Film*>& films);
+
+	size_t getTypeCount(FilmType type) const;
+	size_t getDistinctDirectors() const;
+	size_t countDirector(std::string_view director) const;
+	// Оценка числа сериалов под условием по episodes в предположении равномерности внутри корзины
+	double estimateEpisodes(const Condition& condition) const;
+};
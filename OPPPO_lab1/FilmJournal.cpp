@@ -0,0 +1,120 @@
+#include "FilmJournal.h"
+#include "FileReplace.h"
+#include "GameFilm.h"
+#include "CartoonFilm.h"
+#include "SeriesFilm.h"
+#include <cstdio>
+
+static const size_t COMPACTION_MIN_RECORDS = 1024;
+
+std::string formatAddCommand(const Film& film) {
+    // Название в кавычках сохраняет пробелы по краям и кавычки внутри при повторном разборе
+    std::string line = "ADD " + film.getType() + " \"" + film.getTitle() + "\"|";
+    switch (film.getTypeTag()) {
+    case FilmType::Game:
+        line += static_cast<const GameFilm&>(film).getDirector();
+        break;
+    case FilmType::Cartoon:
+        switch (static_cast<const CartoonFilm&>(film).getCreation()) {
+        case TypeCreation::Drawn: line += "drawn"; break;
+        case TypeCreation::Doll: line += "puppet"; break;
+        case TypeCreation::Plasticine: line += "plasticine"; break;
+        }
+        break;
+    case FilmType::Series: {
+        const SeriesFilm& series = static_cast<const SeriesFilm&>(film);
+        line += series.getDirector() + "|" + std::to_string(series.getEpisode());
+        break;
+    }
+    }
+    return line;
+}
+
+FilmJournal::FilmJournal(const std::string& filename)
+    : filename(filename), file(filename, std::ios::binary | std::ios::app), records(0), groupSize(1), uncommitted(0) {}
+
+bool FilmJournal::isOpen() const {
+    return file.is_open();
+}
+
+const std::string& FilmJournal::getFilename() const {
+    return filename;
+}
+
+size_t FilmJournal::getRecordCount() const {
+    return records;
+}
+
+void FilmJournal::appendAdd(const Film& film) {
+    file << formatAddCommand(film) << '\n';
+    ++records;
+}
+
+void FilmJournal::appendRemove(const std::string& condition) {
+    file << "REM " << condition << '\n';
+    ++records;
+}
+
+void FilmJournal::appendDelete(uint64_t ordinal) {
+    file << "DEL " << ordinal << '\n';
+    ++records;
+}
+
+void FilmJournal::commit() {
+    if (++uncommitted >= groupSize) {
+        flush();
+    }
+}
+
+void FilmJournal::setGroupCommit(size_t mutations) {
+    groupSize = mutations == 0 ? 1 : mutations;
+    if (uncommitted >= groupSize) {
+        flush();
+    }
+}
+
+void FilmJournal::flush() {
+    file.flush();
+    uncommitted = 0;
+}
+
+bool FilmJournal::needsCompaction(size_t liveFilms) const {
+    return records >= COMPACTION_MIN_RECORDS && records > 2 * liveFilms;
+}
+
+bool FilmJournal::compact(const std::vector<const Film*>& films, std::string& error) {
+    std::string temporary = filename + ".tmp";
+    std::ofstream rewritten(temporary, std::ios::binary | std::ios::trunc);
+    if (!rewritten.is_open()) {
+        error = "Cannot create journal file '" + temporary + "'";
+        return false;
+    }
+    for (const Film* film : films) {
+        rewritten << formatAddCommand(*film) << '\n';
+    }
+    rewritten.close();
+    if (rewritten.fail() || !syncFile(temporary)) {
+        error = "Failed to write journal file '" + temporary + "'";
+        std::remove(temporary.c_str());
+        return false;
+    }
+
+    // Windows не заменяет открытый файл, поэтому журнал закрывается на время замены.
+    // При неудаче прежний журнал цел, и записи продолжают дописываться в него
+    file.flush();
+    file.close();
+    if (!replaceFile(temporary, filename)) {
+        error = "Cannot replace journal file '" + filename + "'";
+        std::remove(temporary.c_str());
+        file.open(filename, std::ios::binary | std::ios::app);
+        return false;
+    }
+    file.open(filename, std::ios::binary | std::ios::app);
+    records = films.size();
+    uncommitted = 0;
+    if (!file.is_open()) {
+        error = "Cannot reopen journal file '" + filename + "'";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "Film.h"
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Журнал изменений контейнера в синтаксисе командного файла: его можно воспроизвести через commandFromFile
+class FilmJournal
+{
+private:
+	std::string filename;
+	std::ofstream file;
+	size_t records;
+	size_t groupSize;
+	size_t uncommitted;
+
+public:
+	explicit FilmJournal(const std::string& filename);
+
+	bool isOpen() const;
+	const std::string& getFilename() const;
+	size_t getRecordCount() const;
+
+	void appendAdd(const Film& film);
+	void appendRemove(const std::string& condition);
+	// DEL n удаляет фильм, добавленный n-й записью ADD журнала (с нуля)
+	void appendDelete(uint64_t ordinal);
+	// Отмечает конец примененного изменения (ADD, пакета ADD, REM). Записи уходят в файл каждые
+	// groupSize изменений; по умолчанию 1 - после каждого, больше - групповая запись ценой хвоста при сбое
+	void commit();
+	void setGroupCommit(size_t mutations);
+	void flush();
+
+	bool needsCompaction(size_t liveFilms) const;
+	// Переписывает журнал минимальным набором ADD для текущего состояния
+	bool compact(const std::vector<const Film*>& films, std::string& error);
+};
+
+std::string formatAddCommand(const Film& film);
@@ -0,0 +1,267 @@
+#include "FilmSnapshot.h"
+#include "FileReplace.h"
+#include "GameFilm.h"
+#include "CartoonFilm.h"
+#include "SeriesFilm.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+static const char SNAPSHOT_MAGIC[8] = { 'F', 'I', 'L', 'M', 'S', 'N', 'A', 'P' };
+static const size_t SNAPSHOT_WRITE_BLOCK = 1 << 20;
+// Тип, длина и хотя бы один байт названия, плюс минимальные данные типа
+static const size_t MIN_RECORD_SIZE = 7;
+
+static const uint64_t FNV_OFFSET = 14695981039346656037ull;
+static const uint64_t FNV_PRIME = 1099511628211ull;
+
+static uint64_t updateChecksum(uint64_t hash, const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static void encodeInteger(uint64_t value, char* bytes, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+class SnapshotWriter
+{
+private:
+    std::ofstream file;
+    std::string block;
+    uint64_t checksum;
+
+public:
+    explicit SnapshotWriter(const std::string& filename)
+        : file(filename, std::ios::binary | std::ios::trunc), checksum(FNV_OFFSET) {
+        block.reserve(SNAPSHOT_WRITE_BLOCK);
+    }
+
+    bool isOpen() const {
+        return file.is_open();
+    }
+
+    void writeBytes(const char* data, size_t size) {
+        block.append(data, size);
+        if (block.size() >= SNAPSHOT_WRITE_BLOCK) {
+            flushBlock();
+        }
+    }
+
+    void writeInteger(uint64_t value, size_t size) {
+        char bytes[8];
+        encodeInteger(value, bytes, size);
+        writeBytes(bytes, size);
+    }
+
+    void writeString(const std::string& text) {
+        writeInteger(text.size(), 4);
+        writeBytes(text.data(), text.size());
+    }
+
+    void flushBlock() {
+        checksum = updateChecksum(checksum, block.data(), block.size());
+        file.write(block.data(), static_cast<std::streamsize>(block.size()));
+        block.clear();
+    }
+
+    bool finish() {
+        flushBlock();
+        char trailer[8];
+        encodeInteger(checksum, trailer, sizeof(trailer));
+        file.write(trailer, sizeof(trailer));
+        file.close();
+        return !file.fail();
+    }
+};
+
+class SnapshotReader
+{
+private:
+    const char* data;
+    size_t size;
+    size_t position;
+
+public:
+    SnapshotReader(const char* data, size_t size) : data(data), size(size), position(0) {}
+
+    size_t remaining() const {
+        return size - position;
+    }
+
+    bool readInteger(uint64_t& value, size_t bytes) {
+        if (remaining() < bytes) {
+            return false;
+        }
+        value = 0;
+        for (size_t i = 0; i < bytes; ++i) {
+            value |= static_cast<uint64_t>(static_cast<unsigned char>(data[position + i])) << (8 * i);
+        }
+        position += bytes;
+        return true;
+    }
+
+    bool readString(std::string& text) {
+        uint64_t length = 0;
+        if (!readInteger(length, 4) || remaining() < length) {
+            return false;
+        }
+        text.assign(data + position, static_cast<size_t>(length));
+        position += static_cast<size_t>(length);
+        return true;
+    }
+};
+
+bool writeFilmSnapshot(const std::string& filename, const std::vector<const Film*>& films, std::string& error) {
+    // Снимок пишется рядом и заменяет прежний только целиком: сбой SAVE не портит старый снимок
+    std::string temporary = filename + ".tmp";
+    SnapshotWriter writer(temporary);
+    if (!writer.isOpen()) {
+        error = "Cannot open snapshot file '" + temporary + "' for writing";
+        return false;
+    }
+
+    writer.writeBytes(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    writer.writeInteger(SNAPSHOT_VERSION, 4);
+    writer.writeInteger(films.size(), 8);
+    for (const Film* film : films) {
+        FilmType type = film->getTypeTag();
+        writer.writeInteger(static_cast<uint64_t>(type), 1);
+        writer.writeString(film->getTitle());
+        switch (type) {
+        case FilmType::Game:
+            writer.writeString(static_cast<const GameFilm&>(*film).getDirector());
+            break;
+        case FilmType::Cartoon:
+            writer.writeInteger(static_cast<uint64_t>(static_cast<const CartoonFilm&>(*film).getCreation()), 1);
+            break;
+        case FilmType::Series: {
+            const SeriesFilm& series = static_cast<const SeriesFilm&>(*film);
+            writer.writeString(series.getDirector());
+            writer.writeInteger(static_cast<uint32_t>(series.getEpisode()), 4);
+            break;
+        }
+        }
+    }
+
+    if (!writer.finish() || !syncFile(temporary)) {
+        error = "Failed to write snapshot file '" + temporary + "'";
+        std::remove(temporary.c_str());
+        return false;
+    }
+    if (!replaceFile(temporary, filename)) {
+        error = "Cannot replace snapshot file '" + filename + "'";
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+static bool readRecord(SnapshotReader& reader, std::vector<FilmValue>& films) {
+    uint64_t type = 0;
+    std::string title;
+    if (!reader.readInteger(type, 1) || !reader.readString(title)) {
+        return false;
+    }
+
+    if (type == static_cast<uint64_t>(FilmType::Game)) {
+        std::string director;
+        if (!reader.readString(director)) {
+            return false;
+        }
+        films.emplace_back(std::in_place_type<GameFilm>, title, director);
+    }
+    else if (type == static_cast<uint64_t>(FilmType::Cartoon)) {
+        uint64_t creation = 0;
+        if (!reader.readInteger(creation, 1) || creation > static_cast<uint64_t>(TypeCreation::Plasticine)) {
+            return false;
+        }
+        films.emplace_back(std::in_place_type<CartoonFilm>, title, static_cast<TypeCreation>(creation));
+    }
+    else if (type == static_cast<uint64_t>(FilmType::Series)) {
+        std::string director;
+        uint64_t episodes = 0;
+        if (!reader.readString(director) || !reader.readInteger(episodes, 4)) {
+            return false;
+        }
+        films.emplace_back(std::in_place_type<SeriesFilm>, title, director, static_cast<int32_t>(episodes));
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+bool readFilmSnapshot(const std::string& filename, std::vector<FilmValue>& films, std::string& error) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        error = "Cannot open snapshot file '" + filename + "'";
+        return false;
+    }
+    std::streamoff fileSize = file.tellg();
+    file.seekg(0);
+    std::vector<char> bytes(static_cast<size_t>(fileSize > 0 ? fileSize : 0));
+    if (!file.read(bytes.data(), static_cast<std::streamsize>(bytes.size()))) {
+        error = "Failed to read snapshot file '" + filename + "'";
+        return false;
+    }
+
+    const size_t headerSize = sizeof(SNAPSHOT_MAGIC) + 4 + 8;
+    if (bytes.size() < headerSize + 8 || std::memcmp(bytes.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+        error = "File '" + filename + "' is not a film snapshot";
+        return false;
+    }
+
+    size_t payloadSize = bytes.size() - 8;
+    SnapshotReader trailer(bytes.data() + payloadSize, 8);
+    uint64_t expected = 0;
+    trailer.readInteger(expected, 8);
+    if (updateChecksum(FNV_OFFSET, bytes.data(), payloadSize) != expected) {
+        error = "Snapshot '" + filename + "' checksum mismatch";
+        return false;
+    }
+
+    SnapshotReader reader(bytes.data() + sizeof(SNAPSHOT_MAGIC), payloadSize - sizeof(SNAPSHOT_MAGIC));
+    uint64_t version = 0;
+    uint64_t count = 0;
+    reader.readInteger(version, 4);
+    reader.readInteger(count, 8);
+    if (version != SNAPSHOT_VERSION) {
+        error = "Unsupported snapshot version " + std::to_string(version);
+        return false;
+    }
+    if (count > reader.remaining() / MIN_RECORD_SIZE) {
+        error = "Snapshot '" + filename + "' is truncated or corrupted";
+        return false;
+    }
+
+    std::vector<FilmValue> loaded;
+    loaded.reserve(static_cast<size_t>(count));
+    try {
+        for (uint64_t i = 0; i < count; ++i) {
+            if (!readRecord(reader, loaded)) {
+                error = "Snapshot '" + filename + "' is truncated or corrupted";
+                return false;
+            }
+        }
+    }
+    catch (const std::invalid_argument& e) {
+        error = "Snapshot '" + filename + "' contains an invalid film: " + e.what();
+        return false;
+    }
+
+    if (reader.remaining() != 0) {
+        error = "Snapshot '" + filename + "' is truncated or corrupted";
+        return false;
+    }
+
+    films = std::move(loaded);
+    return true;
+}
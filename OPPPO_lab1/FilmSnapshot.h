@@ -0,0 +1,15 @@
+#pragma once
+#include "Film.h"
+#include "FilmValue.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Формат (little-endian): "FILMSNAP", u32 версия, u64 число фильмов, записи, u64 FNV-1a всех предыдущих байтов.
+// Запись: u8 тип, строка названия (u32 длина + байты), далее по типу:
+// game - строка режиссёра; cartoon - u8 вид анимации; series - строка режиссёра и i32 число серий.
+const unsigned SNAPSHOT_VERSION = 1;
+
+bool writeFilmSnapshot(const std::string& filename, const std::vector<const Film*>& films, std::string& error);
+// Фильмы читаются по значению: контейнер сам размещает их в своем ресурсе памяти
+bool readFilmSnapshot(const std::string& filename, std::vector<FilmValue>& films, std::string& error);
@@ -0,0 +1,29 @@
+#include "FilmValue.h"
+
+const Film& asFilm(const FilmValue& film) {
+    return std::visit([](const auto& value) -> const Film& { return value; }, film);
+}
+
+void FilmDeleter::operator()(Film* film) const {
+    if (!resource) {
+        delete film;
+        return;
+    }
+    size_t size = sizeof(GameFilm);
+    size_t alignment = alignof(GameFilm);
+    switch (film->getTypeTag()) {
+    case FilmType::Game: break;
+    case FilmType::Cartoon: size = sizeof(CartoonFilm); alignment = alignof(CartoonFilm); break;
+    case FilmType::Series: size = sizeof(SeriesFilm); alignment = alignof(SeriesFilm); break;
+    }
+    film->~Film();
+    resource->deallocate(film, size, alignment);
+}
+
+FilmPtr allocateFilm(FilmValue film, std::pmr::memory_resource& resource) {
+    return std::visit([&resource](auto& value) {
+        using Value = std::decay_t<decltype(value)>;
+        void* memory = resource.allocate(sizeof(Value), alignof(Value));
+        return FilmPtr(new (memory) Value(std::move(value)), FilmDeleter{ &resource });
+    }, film);
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "GameFilm.h"
+#include "CartoonFilm.h"
+#include "SeriesFilm.h"
+#include <memory>
+#include <memory_resource>
+#include <variant>
+
+// Фильм по значению: создается при разборе ADD без выделения памяти и затем переносится в ресурс контейнера
+using FilmValue = std::variant<GameFilm, CartoonFilm, SeriesFilm>;
+
+const Film& asFilm(const FilmValue& film);
+
+// Удаляет фильм, созданный через new (resource == nullptr) или в ресурсе памяти
+struct FilmDeleter
+{
+	std::pmr::memory_resource* resource = nullptr;
+
+	void operator()(Film* film) const;
+};
+
+using FilmPtr = std::unique_ptr<Film, FilmDeleter>;
+
+// Переносит фильм в ресурс памяти: одно выделение, строки не копируются
+FilmPtr allocateFilm(FilmValue film, std::pmr::memory_resource& resource);
@@ -1,7 +1,6 @@
 #include "GameFilm.h"
-#include <sstream>
+#include "Condition.h"
 #include <stdexcept>
-#include <iostream>
 
 GameFilm::GameFilm(const std::string& title, const std::string& director)
     : Film(title), director(director) {
@@ -14,45 +13,26 @@ GameFilm::GameFilm(const std::string& title, const std::string& director)
 }
 
 const std::string& GameFilm::getDirector() const {
-    return director;
+    return director.str();
 }
 
 std::string GameFilm::getType() const {
     return "game";
 }
 
-void GameFilm::print() const {
-    std::cout << "Game film: " << title << ", director: " << director << std::endl;
+FilmType GameFilm::getTypeTag() const {
+    return FilmType::Game;
 }
 
-bool GameFilm::matchesCondition(const std::string& condition) const {
-    if (condition.empty()) {
-        return false;
-    }
-
-    std::istringstream iss(condition);
-    std::string field, op;
-    iss >> field >> op;
-
-    std::string value;
-    std::getline(iss, value);
-
-    value.erase(0, value.find_first_not_of(" \t"));
-    value.erase(value.find_last_not_of(" \t") + 1);
+void GameFilm::print(OutputSink& output) const {
+    output << "Game film: " << title << ", director: " << director << '\n';
+}
 
-    if (field == "title") {
-        if (op == "==") return title == value;
-        if (op == "!=") return title != value;
-        if (op == "contains") return title.find(value) != std::string::npos;
-    }
-    else if (field == "director") {
-        if (op == "==") return director == value;
-        if (op == "!=") return director != value;
-        if (op == "contains") return director.find(value) != std::string::npos;
+bool GameFilm::matches(const Condition& condition) const {
+    switch (condition.getField()) {
+    case ConditionField::Title: return condition.matchesString(title);
+    case ConditionField::Director: return condition.matchesString(director);
+    case ConditionField::Type: return condition.matchesType("game");
+    default: return false;
     }
-    else if (field == "type" && op == "==") {
-        return value == "game";
-    }
-
-    return false;
 }
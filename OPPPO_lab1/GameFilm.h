@@ -2,18 +2,20 @@
 #include "Film.h"
 #include <string>
 
-class GameFilm : public Film
+class GameFilm final : public Film
 {
 private:
-	std::string director;
+	InternedString director;
 
 public: 
 	GameFilm(const std::string& title, const std::string& director);
 	
 	const std::string& getDirector() const;
 
-	void print() const override;
-	bool matchesCondition(const std::string& condition) const override;
+	using Film::print;
+	void print(OutputSink& output) const override;
+	bool matches(const Condition& condition) const override;
 	std::string getType() const override;
+	FilmType getTypeTag() const override;
 };
 
@@ -0,0 +1,189 @@
+#include "NumberFilter.h"
+#include <algorithm>
+#include <atomic>
+
+#if defined(FILM_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+// Любой оператор сводится к одному из трех сравнений, возможно с отрицанием результата
+enum class NumberCompare
+{
+    Equal,
+    Greater,
+    Less,
+};
+
+using SelectFunction = void (*)(const int* values, size_t count, int bound, uint64_t* words);
+
+static bool reduceOp(ConditionOp op, NumberCompare& compare, bool& negate) {
+    negate = false;
+    switch (op) {
+    case ConditionOp::Equal: compare = NumberCompare::Equal; return true;
+    case ConditionOp::Greater: compare = NumberCompare::Greater; return true;
+    case ConditionOp::Less: compare = NumberCompare::Less; return true;
+    // != - не ==, <= - не >, >= - не <
+    case ConditionOp::NotEqual: compare = NumberCompare::Equal; negate = true; return true;
+    case ConditionOp::LessEqual: compare = NumberCompare::Greater; negate = true; return true;
+    case ConditionOp::GreaterEqual: compare = NumberCompare::Less; negate = true; return true;
+    default: return false;
+    }
+}
+
+template <NumberCompare compare>
+static uint64_t selectWord(const int* values, size_t count, int bound) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < count; ++i) {
+        bool selected;
+        if constexpr (compare == NumberCompare::Equal) {
+            selected = values[i] == bound;
+        }
+        else if constexpr (compare == NumberCompare::Greater) {
+            selected = values[i] > bound;
+        }
+        else {
+            selected = values[i] < bound;
+        }
+        word |= static_cast<uint64_t>(selected) << i;
+    }
+    return word;
+}
+
+template <NumberCompare compare>
+static void selectScalar(const int* values, size_t count, int bound, uint64_t* words) {
+    for (size_t start = 0; start < count; start += 64) {
+        words[start / 64] = selectWord<compare>(values + start, std::min<size_t>(64, count - start), bound);
+    }
+}
+
+#if defined(FILM_SIMD_X86)
+
+// Слово карты собирается из масок знаков: 16 шагов по 4 числа для SSE2, 8 шагов по 8 для AVX2
+template <NumberCompare compare>
+static void selectSse2(const int* values, size_t count, int bound, uint64_t* words) {
+    const __m128i limit = _mm_set1_epi32(bound);
+    size_t full = count / 64;
+    for (size_t word = 0; word < full; ++word) {
+        const int* block = values + word * 64;
+        uint64_t bits = 0;
+        for (size_t i = 0; i < 64; i += 4) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+            __m128i result;
+            if constexpr (compare == NumberCompare::Equal) {
+                result = _mm_cmpeq_epi32(chunk, limit);
+            }
+            else if constexpr (compare == NumberCompare::Greater) {
+                result = _mm_cmpgt_epi32(chunk, limit);
+            }
+            else {
+                result = _mm_cmpgt_epi32(limit, chunk);
+            }
+            bits |= static_cast<uint64_t>(_mm_movemask_ps(_mm_castsi128_ps(result))) << i;
+        }
+        words[word] = bits;
+    }
+    if (count % 64 != 0) {
+        words[full] = selectWord<compare>(values + full * 64, count % 64, bound);
+    }
+}
+
+template <NumberCompare compare>
+FILM_TARGET_AVX2
+static void selectAvx2(const int* values, size_t count, int bound, uint64_t* words) {
+    const __m256i limit = _mm256_set1_epi32(bound);
+    size_t full = count / 64;
+    for (size_t word = 0; word < full; ++word) {
+        const int* block = values + word * 64;
+        uint64_t bits = 0;
+        for (size_t i = 0; i < 64; i += 8) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+            __m256i result;
+            if constexpr (compare == NumberCompare::Equal) {
+                result = _mm256_cmpeq_epi32(chunk, limit);
+            }
+            else if constexpr (compare == NumberCompare::Greater) {
+                result = _mm256_cmpgt_epi32(chunk, limit);
+            }
+            else {
+                result = _mm256_cmpgt_epi32(limit, chunk);
+            }
+            bits |= static_cast<uint64_t>(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(result)))) << i;
+        }
+        words[word] = bits;
+    }
+    if (count % 64 != 0) {
+        words[full] = selectWord<compare>(values + full * 64, count % 64, bound);
+    }
+}
+
+#endif
+
+template <NumberCompare compare>
+static SelectFunction selectFunction(SimdKernel kernel) {
+#if defined(FILM_SIMD_X86)
+    if (kernel == SimdKernel::Avx2) {
+        return selectAvx2<compare>;
+    }
+    if (kernel == SimdKernel::Sse2) {
+        return selectSse2<compare>;
+    }
+#endif
+    (void)kernel;
+    return selectScalar<compare>;
+}
+
+static std::atomic<SimdKernel>& filterKernel() {
+    static std::atomic<SimdKernel> kernel(bestSimdKernel());
+    return kernel;
+}
+
+SimdKernel activeFilterKernel() {
+    return filterKernel().load(std::memory_order_relaxed);
+}
+
+void setFilterKernel(SimdKernel kernel) {
+    filterKernel().store(isSimdKernelSupported(kernel) ? kernel : bestSimdKernel(), std::memory_order_relaxed);
+}
+
+bool selectNumbers(const int* values, size_t count, ConditionOp op, int bound, std::vector<uint64_t>& bitmap) {
+    NumberCompare compare;
+    bool negate;
+    if (!reduceOp(op, compare, negate)) {
+        bitmap.clear();
+        return false;
+    }
+    bitmap.resize((count + 63) / 64);
+    if (count == 0) {
+        return true;
+    }
+
+    SimdKernel kernel = activeFilterKernel();
+    SelectFunction select = compare == NumberCompare::Equal ? selectFunction<NumberCompare::Equal>(kernel)
+        : compare == NumberCompare::Greater ? selectFunction<NumberCompare::Greater>(kernel)
+        : selectFunction<NumberCompare::Less>(kernel);
+    select(values, count, bound, bitmap.data());
+
+    if (negate) {
+        for (uint64_t& word : bitmap) {
+            word = ~word;
+        }
+        // Биты за концом массива не должны отбираться
+        if (count % 64 != 0) {
+            bitmap.back() &= (uint64_t(1) << (count % 64)) - 1;
+        }
+    }
+    return true;
+}
+
+size_t countSelected(const std::vector<uint64_t>& bitmap) {
+    size_t count = 0;
+    for (uint64_t word : bitmap) {
+#if defined(_MSC_VER)
+        count += static_cast<size_t>(__popcnt64(word));
+#else
+        count += static_cast<size_t>(__builtin_popcountll(word));
+#endif
+    }
+    return count;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "Condition.h"
+#include "SimdKernel.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Ядро отбора чисел; по умолчанию лучшее из поддерживаемых процессором
+SimdKernel activeFilterKernel();
+// Для тестов и замеров; неподдерживаемое ядро заменяется лучшим доступным
+void setFilterKernel(SimdKernel kernel);
+
+// Пакетная проверка числового условия над массивом значений: результат - битовая карта отбора,
+// бит i слова i / 64 установлен, если values[i] подходит.
+// Возвращает false и пустую карту, если оператор не сравнивает числа
+bool selectNumbers(const int* values, size_t count, ConditionOp op, int bound, std::vector<uint64_t>& bitmap);
+
+size_t countSelected(const std::vector<uint64_t>& bitmap);
+
+// Вызывает visit(i) для каждого установленного бита по возрастанию i
+template <typename Visit>
+void forEachSelected(const std::vector<uint64_t>& bitmap, Visit visit) {
+	for (size_t word = 0; word < bitmap.size(); ++word) {
+		uint64_t bits = bitmap[word];
+		while (bits != 0) {
+#if defined(_MSC_VER)
+			unsigned long bit;
+			_BitScanForward64(&bit, bits);
+#else
+			unsigned bit = static_cast<unsigned>(__builtin_ctzll(bits));
+#endif
+			visit(word * 64 + bit);
+			bits &= bits - 1;
+		}
+	}
+}
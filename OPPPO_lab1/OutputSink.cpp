@@ -0,0 +1,81 @@
+#include "OutputSink.h"
+#include <iostream>
+
+OutputSink& OutputSink::operator<<(std::string_view text) {
+    write(text);
+    return *this;
+}
+
+OutputSink& OutputSink::operator<<(const char* text) {
+    write(text);
+    return *this;
+}
+
+OutputSink& OutputSink::operator<<(const std::string& text) {
+    write(text);
+    return *this;
+}
+
+OutputSink& OutputSink::operator<<(char c) {
+    write(std::string_view(&c, 1));
+    return *this;
+}
+
+StreamOutputSink::StreamOutputSink(std::ostream& stream, size_t capacity)
+    : stream(stream), capacity(capacity) {
+    buffer.reserve(capacity);
+}
+
+StreamOutputSink::~StreamOutputSink() {
+    flush();
+}
+
+void StreamOutputSink::write(std::string_view text) {
+    buffer.append(text);
+    if (buffer.size() >= capacity) {
+        stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+}
+
+void StreamOutputSink::flush() {
+    if (!buffer.empty()) {
+        stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+    stream.flush();
+}
+
+FileOutputSink::FileOutputSink(const std::string& filename)
+    : file(filename, std::ios::binary), stream(file) {}
+
+bool FileOutputSink::isOpen() const {
+    return file.is_open();
+}
+
+void FileOutputSink::write(std::string_view text) {
+    stream.write(text);
+}
+
+void FileOutputSink::flush() {
+    stream.flush();
+}
+
+void BufferOutputSink::write(std::string_view chunk) {
+    text.append(chunk);
+}
+
+const std::string& BufferOutputSink::str() const {
+    return text;
+}
+
+void BufferOutputSink::clear() {
+    text.clear();
+}
+
+void NullOutputSink::write(std::string_view) {}
+
+OutputSink& standardOutput() {
+    static StreamOutputSink output(std::cout);
+    return output;
+}
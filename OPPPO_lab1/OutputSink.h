@@ -0,0 +1,80 @@
+#pragma once
+#include <charconv>
+#include <fstream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+class OutputSink
+{
+public:
+	virtual ~OutputSink() = default;
+
+	virtual void write(std::string_view text) = 0;
+	virtual void flush() {}
+
+	OutputSink& operator<<(std::string_view text);
+	OutputSink& operator<<(const char* text);
+	OutputSink& operator<<(const std::string& text);
+	OutputSink& operator<<(char c);
+
+	template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, char> && !std::is_same_v<T, bool>>>
+	OutputSink& operator<<(T value) {
+		char digits[24];
+		auto result = std::to_chars(digits, digits + sizeof(digits), value);
+		write(std::string_view(digits, result.ptr - digits));
+		return *this;
+	}
+};
+
+// Копит вывод и отдаёт его потоку блоками не меньше capacity байт
+class StreamOutputSink : public OutputSink
+{
+private:
+	std::ostream& stream;
+	std::string buffer;
+	size_t capacity;
+
+public:
+	explicit StreamOutputSink(std::ostream& stream, size_t capacity = 1 << 16);
+	~StreamOutputSink() override;
+
+	void write(std::string_view text) override;
+	void flush() override;
+};
+
+class FileOutputSink : public OutputSink
+{
+private:
+	std::ofstream file;
+	StreamOutputSink stream;
+
+public:
+	explicit FileOutputSink(const std::string& filename);
+
+	bool isOpen() const;
+	void write(std::string_view text) override;
+	void flush() override;
+};
+
+class BufferOutputSink : public OutputSink
+{
+private:
+	std::string text;
+
+public:
+	void write(std::string_view chunk) override;
+
+	const std::string& str() const;
+	void clear();
+};
+
+class NullOutputSink : public OutputSink
+{
+public:
+	void write(std::string_view text) override;
+};
+
+// Общий буферизованный stdout; сбрасывается в точках сброса контейнера и команд
+OutputSink& standardOutput();
@@ -1,7 +1,6 @@
 #include "SeriesFilm.h"
-#include <sstream>
+#include "Condition.h"
 #include <stdexcept>
-#include <iostream>
 
 SeriesFilm::SeriesFilm(const std::string& title, const std::string& director, int episodeCount)
     : Film(title), director(director), episodeCount(episodeCount) {
@@ -17,66 +16,31 @@ SeriesFilm::SeriesFilm(const std::string& title, const std::string& director, in
 }
 
 const std::string& SeriesFilm::getDirector() const {
-    return director;
+    return director.str();
 }
 
 int SeriesFilm::getEpisode() const {
     return episodeCount;
 }
 
-void SeriesFilm::print() const {
-    std::cout << "Series film: " << title << ", director: " << director << ", episodes: " << episodeCount << std::endl;
+void SeriesFilm::print(OutputSink& output) const {
+    output << "Series film: " << title << ", director: " << director << ", episodes: " << episodeCount << '\n';
 }
 
 std::string SeriesFilm::getType() const {
     return "series";
 }
 
-bool SeriesFilm::matchesCondition(const std::string& condition) const {
-    if (condition.empty()) {
-        return false;
-    }
-
-    std::istringstream iss(condition);
-    std::string field, op;
-    iss >> field >> op;
-
-    std::string value;
-    std::getline(iss, value);
-
-    value.erase(0, value.find_first_not_of(" \t"));
-    value.erase(value.find_last_not_of(" \t") + 1);
+FilmType SeriesFilm::getTypeTag() const {
+    return FilmType::Series;
+}
 
-    if (field == "title") {
-        if (op == "==") return title == value;
-        if (op == "!=") return title != value;
-        if (op == "contains") return title.find(value) != std::string::npos;
+bool SeriesFilm::matches(const Condition& condition) const {
+    switch (condition.getField()) {
+    case ConditionField::Title: return condition.matchesString(title);
+    case ConditionField::Director: return condition.matchesString(director);
+    case ConditionField::Episodes: return condition.matchesNumber(episodeCount);
+    case ConditionField::Type: return condition.matchesType("series");
+    default: return false;
     }
-    else if (field == "director") {
-        if (op == "==") return director == value;
-        if (op == "!=") return director != value;
-        if (op == "contains") return director.find(value) != std::string::npos;
-    }
-    else if (field == "episodes") {
-        try {
-            int numValue = std::stoi(value);
-            if (op == "==") return episodeCount == numValue;
-            if (op == "!=") return episodeCount != numValue;
-            if (op == ">") return episodeCount > numValue;
-            if (op == "<") return episodeCount < numValue;
-            if (op == ">=") return episodeCount >= numValue;
-            if (op == "<=") return episodeCount <= numValue;
-        }
-        catch (const std::invalid_argument&) {
-            return false;
-        }
-        catch (const std::out_of_range&) {
-            return false;
-        }
-    }
-    else if (field == "type" && op == "==") {
-        return value == "series";
-    }
-
-    return false;
 }
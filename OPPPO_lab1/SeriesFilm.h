@@ -2,10 +2,10 @@
 #include "Film.h"
 #include <string>
 
-class SeriesFilm : public Film
+class SeriesFilm final : public Film
 {
 private:
-	std::string director;
+	InternedString director;
 	int episodeCount;
 
 public:
@@ -14,9 +14,11 @@ public:
 	const std::string& getDirector() const;
 	int getEpisode() const;
 
-	void print() const override;
+	using Film::print;
+	void print(OutputSink& output) const override;
 
-	bool matchesCondition(const std::string& condition) const override;
+	bool matches(const Condition& condition) const override;
 	std::string getType() const override;
+	FilmType getTypeTag() const override;
 };
 
@@ -0,0 +1,68 @@
+#include "SimdKernel.h"
+
+#if defined(FILM_SIMD_X86) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+#if defined(FILM_SIMD_X86)
+static bool cpuHasAvx2() {
+#if defined(__GNUC__)
+    // Проверка учитывает и поддержку регистров YMM операционной системой
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return false;
+#endif
+}
+#endif
+
+const char* simdKernelName(SimdKernel kernel) {
+    switch (kernel) {
+    case SimdKernel::Sse2: return "sse2";
+    case SimdKernel::Avx2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+bool isSimdKernelSupported(SimdKernel kernel) {
+    switch (kernel) {
+    case SimdKernel::Scalar:
+        return true;
+#if defined(FILM_SIMD_X86)
+    case SimdKernel::Sse2:
+        // SSE2 входит в базовый набор x86-64
+        return true;
+    case SimdKernel::Avx2: {
+        static const bool supported = cpuHasAvx2();
+        return supported;
+    }
+#endif
+    default:
+        return false;
+    }
+}
+
+SimdKernel bestSimdKernel() {
+    if (isSimdKernelSupported(SimdKernel::Avx2)) {
+        return SimdKernel::Avx2;
+    }
+    if (isSimdKernelSupported(SimdKernel::Sse2)) {
+        return SimdKernel::Sse2;
+    }
+    return SimdKernel::Scalar;
+}
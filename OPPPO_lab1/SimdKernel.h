@@ -0,0 +1,25 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define FILM_SIMD_X86 1
+#endif
+
+// GCC и Clang собирают AVX2-функции без флагов для всего файла; MSVC разрешает интринсики и так
+#if defined(__GNUC__)
+#define FILM_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define FILM_TARGET_AVX2
+#endif
+
+// Набор векторных инструкций для пакетных проверок: поиска строк и отбора чисел.
+// Каждый модуль выбирает свое ядро сам, здесь только проверка поддержки процессором
+enum class SimdKernel
+{
+	Scalar,
+	Sse2,
+	Avx2,
+};
+
+const char* simdKernelName(SimdKernel kernel);
+bool isSimdKernelSupported(SimdKernel kernel);
+SimdKernel bestSimdKernel();
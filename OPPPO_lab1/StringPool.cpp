@@ -0,0 +1,159 @@
+#include "StringPool.h"
+#include <functional>
+#include <utility>
+
+// Запись пула и узел хеш-таблицы: пара ключ-значение, указатель на следующий узел, сохраненный хеш
+// и ячейка корзины на каждую запись
+static constexpr size_t ENTRY_OVERHEAD = sizeof(StringPool::Entry)
+    + sizeof(std::pair<const std::string_view, std::unique_ptr<StringPool::Entry>>) + 3 * sizeof(void*);
+
+size_t StringPoolStats::sharedBytes() const {
+    return referencedBytes - storedBytes;
+}
+
+int64_t StringPoolStats::savedBytes() const {
+    return static_cast<int64_t>(sharedBytes()) - static_cast<int64_t>(overheadBytes);
+}
+
+StringPool& StringPool::shared() {
+    // Пул не разрушается при выходе, чтобы пережить статические объекты с фильмами
+    static StringPool* pool = new StringPool();
+    return *pool;
+}
+
+std::unique_lock<std::mutex> StringPool::lock(Shard& shard) {
+    std::unique_lock<std::mutex> guard(shard.mutex, std::try_to_lock);
+    if (!guard.owns_lock()) {
+        guard.lock();
+        shard.stats.contendedLocks++;
+    }
+    shard.stats.lockAcquisitions++;
+    return guard;
+}
+
+StringPool::Shard& StringPool::shardOf(std::string_view text) const {
+    return shards[std::hash<std::string_view>()(text) % SHARD_COUNT];
+}
+
+InternedString StringPool::intern(std::string_view text) {
+    Shard& shard = shardOf(text);
+    auto guard = lock(shard);
+    auto it = shard.entries.find(text);
+    if (it == shard.entries.end()) {
+        auto entry = std::make_unique<Entry>();
+        entry->text = std::string(text);
+        entry->shard = static_cast<size_t>(&shard - shards.data());
+        std::string_view key = entry->text;
+        it = shard.entries.emplace(key, std::move(entry)).first;
+        shard.stats.distinctStrings++;
+        shard.stats.storedBytes += text.size();
+        shard.stats.overheadBytes += ENTRY_OVERHEAD;
+    }
+    Entry* entry = it->second.get();
+    entry->references++;
+    shard.stats.references++;
+    shard.stats.referencedBytes += text.size();
+    return InternedString(entry);
+}
+
+InternedString StringPool::find(std::string_view text) {
+    Shard& shard = shardOf(text);
+    auto guard = lock(shard);
+    auto it = shard.entries.find(text);
+    if (it == shard.entries.end()) {
+        return InternedString();
+    }
+    Entry* entry = it->second.get();
+    entry->references++;
+    shard.stats.references++;
+    shard.stats.referencedBytes += text.size();
+    return InternedString(entry);
+}
+
+StringPoolStats StringPool::getStats() const {
+    StringPoolStats total;
+    for (Shard& shard : shards) {
+        std::lock_guard<std::mutex> guard(shard.mutex);
+        total.distinctStrings += shard.stats.distinctStrings;
+        total.references += shard.stats.references;
+        total.storedBytes += shard.stats.storedBytes;
+        total.referencedBytes += shard.stats.referencedBytes;
+        total.overheadBytes += shard.stats.overheadBytes;
+        total.lockAcquisitions += shard.stats.lockAcquisitions;
+        total.contendedLocks += shard.stats.contendedLocks;
+    }
+    return total;
+}
+
+void StringPool::retain(const Entry* entry) {
+    Shard& shard = shards[entry->shard];
+    auto guard = lock(shard);
+    const_cast<Entry*>(entry)->references++;
+    shard.stats.references++;
+    shard.stats.referencedBytes += entry->text.size();
+}
+
+void StringPool::release(const Entry* entry) {
+    Shard& shard = shards[entry->shard];
+    auto guard = lock(shard);
+    shard.stats.references--;
+    shard.stats.referencedBytes -= entry->text.size();
+    if (--const_cast<Entry*>(entry)->references == 0) {
+        shard.stats.distinctStrings--;
+        shard.stats.storedBytes -= entry->text.size();
+        shard.stats.overheadBytes -= ENTRY_OVERHEAD;
+        shard.entries.erase(shard.entries.find(entry->text));
+    }
+}
+
+InternedString::InternedString(const StringPool::Entry* entry) : entry(entry) {}
+
+InternedString::InternedString(std::string_view text) : InternedString(StringPool::shared().intern(text)) {}
+
+InternedString::InternedString(const InternedString& other) : entry(other.entry) {
+    if (entry) {
+        StringPool::shared().retain(entry);
+    }
+}
+
+InternedString::InternedString(InternedString&& other) noexcept : entry(other.entry) {
+    other.entry = nullptr;
+}
+
+InternedString& InternedString::operator=(const InternedString& other) {
+    InternedString copy(other);
+    std::swap(entry, copy.entry);
+    return *this;
+}
+
+InternedString& InternedString::operator=(InternedString&& other) noexcept {
+    std::swap(entry, other.entry);
+    return *this;
+}
+
+InternedString::~InternedString() {
+    if (entry) {
+        StringPool::shared().release(entry);
+    }
+}
+
+const std::string& InternedString::str() const {
+    static const std::string empty;
+    return entry ? entry->text : empty;
+}
+
+InternedString::operator std::string_view() const {
+    return str();
+}
+
+bool InternedString::empty() const {
+    return str().empty();
+}
+
+bool InternedString::operator==(const InternedString& other) const {
+    return entry == other.entry;
+}
+
+bool InternedString::operator!=(const InternedString& other) const {
+    return entry != other.entry;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class InternedString;
+
+struct StringPoolStats
+{
+	size_t distinctStrings = 0;
+	size_t references = 0;
+	size_t storedBytes = 0;
+	size_t referencedBytes = 0;
+	// Узлы хеш-таблицы и записи пула, которых не было бы у отдельных копий
+	size_t overheadBytes = 0;
+	size_t lockAcquisitions = 0;
+	// Захваты, которым пришлось ждать другой поток
+	size_t contendedLocks = 0;
+
+	// Байты, которые заняли бы отдельные копии строк сверх одной копии каждого значения
+	size_t sharedBytes() const;
+	// То же за вычетом накладных расходов пула; отрицательно, если повторов мало
+	int64_t savedBytes() const;
+};
+
+// Общий пул строк с подсчетом ссылок; строка удаляется, когда на нее не остается ссылок.
+// Пул разбит на части по хешу строки, у каждой свой мьютекс, чтобы параллельный разбор не ждал одной блокировки
+class StringPool
+{
+public:
+	struct Entry
+	{
+		std::string text;
+		size_t references = 0;
+		size_t shard = 0;
+	};
+
+	static constexpr size_t SHARD_COUNT = 16;
+
+private:
+	struct Shard
+	{
+		std::unordered_map<std::string_view, std::unique_ptr<Entry>> entries;
+		std::mutex mutex;
+		StringPoolStats stats;
+	};
+
+	mutable std::array<Shard, SHARD_COUNT> shards;
+
+	StringPool() = default;
+
+	static std::unique_lock<std::mutex> lock(Shard& shard);
+	Shard& shardOf(std::string_view text) const;
+
+	friend class InternedString;
+	void retain(const Entry* entry);
+	void release(const Entry* entry);
+
+public:
+	static StringPool& shared();
+
+	InternedString intern(std::string_view text);
+	// Пустая ссылка, если такой строки в пуле нет; в пул ничего не добавляется
+	InternedString find(std::string_view text);
+	StringPoolStats getStats() const;
+};
+
+// Ссылка на строку из пула: одна копия на каждое различное значение, равенство проверяется по адресу
+class InternedString
+{
+private:
+	const StringPool::Entry* entry = nullptr;
+
+	friend class StringPool;
+	explicit InternedString(const StringPool::Entry* entry);
+
+public:
+	InternedString() = default;
+	InternedString(std::string_view text);
+	InternedString(const InternedString& other);
+	InternedString(InternedString&& other) noexcept;
+	InternedString& operator=(const InternedString& other);
+	InternedString& operator=(InternedString&& other) noexcept;
+	~InternedString();
+
+	const std::string& str() const;
+	operator std::string_view() const;
+	bool empty() const;
+
+	bool operator==(const InternedString& other) const;
+	bool operator!=(const InternedString& other) const;
+};
@@ -0,0 +1,218 @@
+#include "StringSearch.h"
+#include <atomic>
+#include <cstring>
+
+#if defined(FILM_SIMD_X86)
+#include <emmintrin.h>
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+using SearchFunction = size_t (*)(const char* data, size_t size, size_t from, std::string_view needle);
+using EqualFunction = bool (*)(const char* left, const char* right, size_t size);
+
+static size_t searchScalar(const char* data, size_t size, size_t from, std::string_view needle) {
+    return std::string_view(data, size).find(needle, from);
+}
+
+static bool equalScalar(const char* left, const char* right, size_t size) {
+    return std::memcmp(left, right, size) == 0;
+}
+
+#if defined(FILM_SIMD_X86)
+
+static unsigned lowestBit(unsigned mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+// Позиция-кандидат должна совпасть по первому и последнему байту образца; середина сверяется memcmp
+static size_t searchSse2(const char* data, size_t size, size_t from, std::string_view needle) {
+    size_t length = needle.size();
+    if (length < 2 || length > size) {
+        return searchScalar(data, size, from, needle);
+    }
+    const __m128i first = _mm_set1_epi8(needle.front());
+    const __m128i last = _mm_set1_epi8(needle.back());
+    size_t position = from;
+    for (; position + length + 15 <= size; position += 16) {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position + length - 1));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(first, blockFirst), _mm_cmpeq_epi8(last, blockLast))));
+        while (mask != 0) {
+            size_t candidate = position + lowestBit(mask);
+            if (std::memcmp(data + candidate + 1, needle.data() + 1, length - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    return searchScalar(data, size, position, needle);
+}
+
+static bool equalSse2(const char* left, const char* right, size_t size) {
+    size_t position = 0;
+    for (; position + 16 <= size; position += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(left + position));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(right + position));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF) {
+            return false;
+        }
+    }
+    return equalScalar(left + position, right + position, size - position);
+}
+
+FILM_TARGET_AVX2
+static size_t searchAvx2(const char* data, size_t size, size_t from, std::string_view needle) {
+    size_t length = needle.size();
+    if (length < 2 || length > size) {
+        return searchScalar(data, size, from, needle);
+    }
+    const __m256i first = _mm256_set1_epi8(needle.front());
+    const __m256i last = _mm256_set1_epi8(needle.back());
+    size_t position = from;
+    for (; position + length + 31 <= size; position += 32) {
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position + length - 1));
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+            _mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst), _mm256_cmpeq_epi8(last, blockLast))));
+        while (mask != 0) {
+            size_t candidate = position + lowestBit(mask);
+            if (std::memcmp(data + candidate + 1, needle.data() + 1, length - 2) == 0) {
+                return candidate;
+            }
+            mask &= mask - 1;
+        }
+    }
+    // Остаток короче 32 позиций добирается SSE2
+    return searchSse2(data, size, position, needle);
+}
+
+FILM_TARGET_AVX2
+static bool equalAvx2(const char* left, const char* right, size_t size) {
+    size_t position = 0;
+    for (; position + 32 <= size; position += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(left + position));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(right + position));
+        if (static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(a, b))) != 0xFFFFFFFFu) {
+            return false;
+        }
+    }
+    return equalSse2(left + position, right + position, size - position);
+}
+
+#endif
+
+struct KernelTable
+{
+    std::atomic<SimdKernel> kernel;
+    std::atomic<SearchFunction> search;
+    std::atomic<EqualFunction> equal;
+
+    explicit KernelTable(SimdKernel selected) {
+        select(selected);
+    }
+
+    void select(SimdKernel selected) {
+        SearchFunction searchFunction = searchScalar;
+        EqualFunction equalFunction = equalScalar;
+#if defined(FILM_SIMD_X86)
+        if (selected == SimdKernel::Avx2) {
+            searchFunction = searchAvx2;
+            equalFunction = equalAvx2;
+        }
+        else if (selected == SimdKernel::Sse2) {
+            searchFunction = searchSse2;
+            equalFunction = equalSse2;
+        }
+#endif
+        search.store(searchFunction, std::memory_order_relaxed);
+        equal.store(equalFunction, std::memory_order_relaxed);
+        kernel.store(selected, std::memory_order_relaxed);
+    }
+};
+
+static KernelTable& kernels() {
+    static KernelTable table(bestSimdKernel());
+    return table;
+}
+
+SimdKernel activeSearchKernel() {
+    return kernels().kernel.load(std::memory_order_relaxed);
+}
+
+void setSearchKernel(SimdKernel kernel) {
+    kernels().select(isSimdKernelSupported(kernel) ? kernel : bestSimdKernel());
+}
+
+bool containsBytes(std::string_view text, std::string_view needle) {
+    SearchFunction search = kernels().search.load(std::memory_order_relaxed);
+    return search(text.data(), text.size(), 0, needle) != std::string_view::npos;
+}
+
+bool equalBytes(std::string_view left, std::string_view right) {
+    if (left.size() != right.size()) {
+        return false;
+    }
+    EqualFunction equal = kernels().equal.load(std::memory_order_relaxed);
+    return equal(left.data(), right.data(), left.size());
+}
+
+void BatchSearch::clear() {
+    buffer.clear();
+    starts.clear();
+}
+
+void BatchSearch::add(std::string_view text) {
+    starts.push_back(buffer.size());
+    buffer.append(text);
+    buffer.push_back('\0');
+}
+
+size_t BatchSearch::size() const {
+    return starts.size();
+}
+
+void BatchSearch::containsEach(std::string_view needle, std::vector<unsigned char>& hits) const {
+    if (needle.empty()) {
+        hits.assign(starts.size(), 1);
+        return;
+    }
+    hits.assign(starts.size(), 0);
+    if (needle.find('\0') != std::string_view::npos) {
+        // Образец с нулевым байтом мог бы пересечь границу строк - проверяем каждую отдельно
+        for (size_t i = 0; i < starts.size(); ++i) {
+            size_t end = (i + 1 < starts.size() ? starts[i + 1] : buffer.size()) - 1;
+            std::string_view text(buffer.data() + starts[i], end - starts[i]);
+            hits[i] = text.find(needle) != std::string_view::npos;
+        }
+        return;
+    }
+
+    // Совпадения идут по возрастанию; после попадания поиск продолжается со следующей строки
+    SearchFunction search = kernels().search.load(std::memory_order_relaxed);
+    size_t from = 0;
+    size_t index = 0;
+    while (true) {
+        size_t found = search(buffer.data(), buffer.size(), from, needle);
+        if (found == std::string_view::npos) {
+            return;
+        }
+        while (index + 1 < starts.size() && starts[index + 1] <= found) {
+            ++index;
+        }
+        hits[index] = 1;
+        if (index + 1 >= starts.size()) {
+            return;
+        }
+        from = starts[index + 1];
+    }
+}
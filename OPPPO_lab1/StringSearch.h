@@ -0,0 +1,31 @@
+#pragma once
+#include "SimdKernel.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Ядро поиска подстроки: AVX2 и SSE2 проверяют 32 и 16 позиций за шаг по первому и последнему байту образца.
+// По умолчанию выбирается лучшее ядро, которое поддерживает процессор
+SimdKernel activeSearchKernel();
+// Для тестов и замеров; неподдерживаемое ядро заменяется лучшим доступным
+void setSearchKernel(SimdKernel kernel);
+
+bool containsBytes(std::string_view text, std::string_view needle);
+bool equalBytes(std::string_view left, std::string_view right);
+
+// Пакетный поиск по многим строкам: строки склеиваются через '\0' и просматриваются одним проходом,
+// поэтому короткие названия тоже обрабатываются векторными шагами
+class BatchSearch
+{
+private:
+	std::string buffer;
+	std::vector<size_t> starts;
+
+public:
+	void clear();
+	void add(std::string_view text);
+	size_t size() const;
+
+	// hits[i] = 1, если i-я добавленная строка содержит needle
+	void containsEach(std::string_view needle, std::vector<unsigned char>& hits) const;
+};
@@ -0,0 +1,87 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads)
+    : wakeSignal(wakePromise.get_future().share()), task(nullptr), taskCount(0), chunkCount(0),
+      nextChunk(0), pendingChunks(0), stopping(false) {
+    if (threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        wakeWorkers();
+    }
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned ThreadPool::size() const {
+    return static_cast<unsigned>(workers.size()) + 1;
+}
+
+void ThreadPool::wakeWorkers() {
+    wakePromise.set_value();
+    wakePromise = std::promise<void>();
+    wakeSignal = wakePromise.get_future().share();
+}
+
+void ThreadPool::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        std::shared_future<void> signal = wakeSignal;
+        lock.unlock();
+        signal.wait();
+        lock.lock();
+        runChunks(lock);
+    }
+}
+
+void ThreadPool::runChunks(std::unique_lock<std::mutex>& lock) {
+    while (nextChunk < chunkCount) {
+        size_t chunk = nextChunk++;
+        size_t begin = taskCount * chunk / chunkCount;
+        size_t end = taskCount * (chunk + 1) / chunkCount;
+        const std::function<void(size_t, size_t)>& body = *task;
+        lock.unlock();
+        body(begin, end);
+        lock.lock();
+        if (--pendingChunks == 0) {
+            donePromise.set_value();
+        }
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t, size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+    if (workers.empty() || count == 1) {
+        body(0, count);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    task = &body;
+    taskCount = count;
+    chunkCount = std::min(count, static_cast<size_t>(size()) * 4);
+    nextChunk = 0;
+    pendingChunks = chunkCount;
+    donePromise = std::promise<void>();
+    std::future<void> finished = donePromise.get_future();
+    wakeWorkers();
+
+    runChunks(lock);
+    lock.unlock();
+    finished.wait();
+    lock.lock();
+    task = nullptr;
+    chunkCount = 0;
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+private:
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	// Сигналы через promise/future, а не condition_variable: так бинарник
+	// не требует свежего libstdc++ (wait() там перевыпущен в GLIBCXX_3.4.30)
+	std::promise<void> wakePromise;
+	std::shared_future<void> wakeSignal;
+	std::promise<void> donePromise;
+
+	const std::function<void(size_t, size_t)>* task;
+	size_t taskCount;
+	size_t chunkCount;
+	size_t nextChunk;
+	size_t pendingChunks;
+	bool stopping;
+
+	void workerLoop();
+	void runChunks(std::unique_lock<std::mutex>& lock);
+	void wakeWorkers();
+
+public:
+	// threads == 0 означает число аппаратных потоков
+	explicit ThreadPool(unsigned threads = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned size() const;
+
+	// Делит [0, count) на непрерывные куски и ждёт их обработки; body не должен бросать исключений
+	void parallelFor(size_t count, const std::function<void(size_t, size_t)>& body);
+};
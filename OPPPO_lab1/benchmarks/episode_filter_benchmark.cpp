@@ -0,0 +1,69 @@
+#include "NumberFilter.h"
+#include "SeriesFilm.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Проверка episodes > N: по объектам через виртуальный matches и по столбцу чисел каждым ядром
+template <typename Body>
+static double measure(Body body, size_t& hits) {
+    auto start = std::chrono::steady_clock::now();
+    hits = body();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+static void report(const std::string& name, double milliseconds, size_t hits, size_t count) {
+    std::cout << name << ": " << milliseconds << " ms, " << hits << " hit(s), "
+        << count / milliseconds / 1e6 << " G comparison(s)/s" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 16000000;
+    size_t objects = std::min<size_t>(count, 1000000);
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> episodes(1, 1000);
+    std::vector<int> values(count);
+    for (int& value : values) {
+        value = episodes(random);
+    }
+    Condition condition = Condition::compile("episodes > 900");
+    std::cout << "Values: " << count << ", condition: '" << condition.getText() << "'" << std::endl;
+
+    std::vector<std::unique_ptr<Film>> films;
+    films.reserve(objects);
+    for (size_t i = 0; i < objects; ++i) {
+        films.push_back(std::make_unique<SeriesFilm>("Series", "Director", values[i]));
+    }
+    size_t hits = 0;
+    double virtualCalls = measure([&]() {
+        size_t found = 0;
+        for (const auto& film : films) {
+            found += film->matches(condition);
+        }
+        return found;
+    }, hits);
+    report("Film::matches (" + std::to_string(objects) + " objects)", virtualCalls, hits, objects);
+
+    SimdKernel initial = activeFilterKernel();
+    std::vector<uint64_t> bitmap;
+    for (SimdKernel kernel : { SimdKernel::Scalar, SimdKernel::Sse2, SimdKernel::Avx2 }) {
+        if (!isSimdKernelSupported(kernel)) {
+            std::cout << simdKernelName(kernel) << ": not supported" << std::endl;
+            continue;
+        }
+        setFilterKernel(kernel);
+        // Первый проход прогревает карту отбора, замеряется второй
+        selectNumbers(values.data(), values.size(), condition.getOp(), condition.getNumber(), bitmap);
+        double selection = measure([&]() {
+            selectNumbers(values.data(), values.size(), condition.getOp(), condition.getNumber(), bitmap);
+            return countSelected(bitmap);
+        }, hits);
+        report(simdKernelName(kernel), selection, hits, count);
+    }
+    setFilterKernel(initial);
+    return 0;
+}
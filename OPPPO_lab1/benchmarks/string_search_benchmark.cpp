@@ -0,0 +1,104 @@
+#include "StringSearch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Сравнение ядер поиска подстроки на наборе названий: std::search по каждой строке,
+// containsBytes по каждой строке для каждого ядра и пакетный BatchSearch
+static std::vector<std::string> makeTitles(size_t count) {
+    static const char* words[] = {
+        "Star", "Night", "Return", "Dragon", "Legend", "Shadow", "City", "Dream",
+        "Winter", "Empire", "Ocean", "Ghost", "Silent", "Iron", "Golden", "Quest"
+    };
+    std::mt19937 random(42);
+    std::uniform_int_distribution<size_t> word(0, sizeof(words) / sizeof(words[0]) - 1);
+    std::uniform_int_distribution<int> length(2, 5);
+    std::uniform_int_distribution<int> number(1, 999);
+
+    std::vector<std::string> titles;
+    titles.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string title;
+        int words_count = length(random);
+        for (int w = 0; w < words_count; ++w) {
+            if (w > 0) {
+                title.push_back(' ');
+            }
+            title += words[word(random)];
+        }
+        title += ' ' + std::to_string(number(random));
+        titles.push_back(std::move(title));
+    }
+    return titles;
+}
+
+template <typename Body>
+static double measure(Body body, size_t& hits) {
+    auto start = std::chrono::steady_clock::now();
+    hits = body();
+    auto finish = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(finish - start).count();
+}
+
+static void report(const std::string& name, double milliseconds, size_t hits, double baseline) {
+    std::cout << name << ": " << milliseconds << " ms, " << hits << " hit(s), x"
+        << baseline / milliseconds << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    std::string needle = argc > 2 ? argv[2] : "Ghost 7";
+    std::vector<std::string> titles = makeTitles(count);
+    std::cout << "Titles: " << titles.size() << ", needle: '" << needle << "'" << std::endl;
+
+    size_t hits = 0;
+    double baseline = measure([&]() {
+        size_t found = 0;
+        for (const std::string& title : titles) {
+            found += std::search(title.begin(), title.end(), needle.begin(), needle.end()) != title.end();
+        }
+        return found;
+    }, hits);
+    report("std::search", baseline, hits, baseline);
+
+    // Контейнер держит склеенный буфер в разделе и дописывает в него только новые фильмы,
+    // поэтому склейка - разовая стоимость и печатается отдельно от поиска
+    BatchSearch search;
+    double joining = measure([&]() {
+        for (const std::string& title : titles) {
+            search.add(title);
+        }
+        return search.size();
+    }, hits);
+    std::cout << "batch join: " << joining << " ms" << std::endl;
+
+    SimdKernel initial = activeSearchKernel();
+    for (SimdKernel kernel : { SimdKernel::Scalar, SimdKernel::Sse2, SimdKernel::Avx2 }) {
+        if (!isSimdKernelSupported(kernel)) {
+            std::cout << simdKernelName(kernel) << ": not supported" << std::endl;
+            continue;
+        }
+        setSearchKernel(kernel);
+        double single = measure([&]() {
+            size_t found = 0;
+            for (const std::string& title : titles) {
+                found += containsBytes(title, needle);
+            }
+            return found;
+        }, hits);
+        report(std::string(simdKernelName(kernel)) + " per title", single, hits, baseline);
+
+        std::vector<unsigned char> marks;
+        double batch = measure([&]() {
+            search.containsEach(needle, marks);
+            return static_cast<size_t>(std::count(marks.begin(), marks.end(), 1));
+        }, hits);
+        report(std::string(simdKernelName(kernel)) + " batch", batch, hits, baseline);
+    }
+    setSearchKernel(initial);
+    return 0;
+}
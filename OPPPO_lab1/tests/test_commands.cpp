@@ -8,173 +8,10 @@
 #include "GameFilm.h"
 #include "CartoonFilm.h"
 #include "SeriesFilm.h"
-
-std::unique_ptr<Film> createFilm(const std::string& type, const std::string& title, const std::string& additionalData);
-void processAddCommand(std::istringstream& iss, FilmContainer& container);
-void processRemoveCommand(std::istringstream& iss, FilmContainer& container);
-void commandFromFile(const std::string& filename, FilmContainer& container);
-
-std::unique_ptr<Film> createFilm(const std::string& type, const std::string& title, const std::string& additionalData)
-{
-    if (type.empty() || title.empty()) {
-        throw std::invalid_argument("Film type and title cannot be empty");
-    }
-
-    std::istringstream iss(additionalData);
-
-    if (type == "game") {
-        std::string director;
-        std::getline(iss, director);
-        if (director.empty()) {
-            throw std::invalid_argument("Director cannot be empty for game film");
-        }
-        return std::make_unique<GameFilm>(title, director);
-    }
-    else if (type == "cartoon") {
-        std::string animType;
-        iss >> animType;
-        if (animType.empty()) {
-            throw std::invalid_argument("Animation type cannot be empty for cartoon film");
-        }
-        TypeCreation typeEnum;
-        if (animType == "drawn") typeEnum = TypeCreation::Drawn;
-        else if (animType == "puppet") typeEnum = TypeCreation::Doll;
-        else if (animType == "plasticine") typeEnum = TypeCreation::Plasticine;
-        else {
-            throw std::invalid_argument("Invalid animation type: '" + animType + "'. Use: drawn, puppet, plasticine");
-        }
-        return std::make_unique<CartoonFilm>(title, typeEnum);
-    }
-    else if (type == "series") {
-        std::string director;
-        int episodes = 0;
-        if (!std::getline(iss, director, '|')) {
-            throw std::invalid_argument("Missing director for series film");
-        }
-        director.erase(0, director.find_first_not_of(" \t"));
-        director.erase(director.find_last_not_of(" \t") + 1);
-        if (director.empty()) {
-            throw std::invalid_argument("Director cannot be empty for series film");
-        }
-        if (!(iss >> episodes)) {
-            throw std::invalid_argument("Missing or invalid episode count for series film");
-        }
-        if (episodes <= 0) {
-            throw std::invalid_argument("Episode count must be positive for series film");
-        }
-        return std::make_unique<SeriesFilm>(title, director, episodes);
-    }
-    else {
-        throw std::invalid_argument("Unknown film type: '" + type + "'. Use: game, cartoon, or series");
-    }
-}
-
-void processAddCommand(std::istringstream& iss, FilmContainer& container) {
-    std::string type, title, additionalData;
-    if (!(iss >> type)) {
-        std::cout << "Error: Missing film type after ADD command" << std::endl;
-        return;
-    }
-    iss >> std::ws;
-    if (!std::getline(iss, title, '|')) {
-        std::cout << "Error: Missing title for ADD command. Format: ADD type title|additional_data" << std::endl;
-        return;
-    }
-    if (!title.empty() && title.front() == '"' && title.back() == '"') {
-        title = title.substr(1, title.length() - 2);
-    }
-    std::getline(iss, additionalData);
-    additionalData.erase(0, additionalData.find_first_not_of(" \t"));
-
-    try {
-        std::vector<std::string> params;
-        params.push_back(title);
-        if (type == "cartoon") {
-            std::istringstream dataStream(additionalData);
-            std::string animType;
-            dataStream >> animType;
-            params.push_back(animType);
-        }
-        else if (type == "game") {
-            params.push_back(additionalData);
-        }
-        else if (type == "series") {
-            std::istringstream dataStream(additionalData);
-            std::string director;
-            std::string episodesStr;
-            std::getline(dataStream, director, '|');
-            dataStream >> episodesStr;
-            params.push_back(director);
-            params.push_back(episodesStr);
-        }
-        if (!FilmContainer::validateAddCommand(type, params)) {
-            return;
-        }
-        auto film = createFilm(type, title, additionalData);
-        container.addFilm(std::move(film));
-    }
-    catch (const std::exception& e) {
-        std::cout << "Error creating film: " << e.what() << std::endl;
-    }
-    catch (...) {
-        std::cout << "Unknown error occurred while creating film" << std::endl;
-    }
-}
-
-void processRemoveCommand(std::istringstream& iss, FilmContainer& container) {
-    std::string condition;
-    std::getline(iss >> std::ws, condition);
-    if (condition.empty()) {
-        std::cout << "Error: Missing condition for REM command" << std::endl;
-        return;
-    }
-    container.removeFilms(condition);
-}
-
-void commandFromFile(const std::string& filename, FilmContainer& container) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cout << "Error: Cannot open file '" << filename << "'" << std::endl;
-        return;
-    }
-
-    std::string line;
-    int lineNumber = 0;
-    while (std::getline(file, line)) {
-        lineNumber++;
-        if (line.empty() || line[0] == '#') {
-            continue;
-        }
-        std::istringstream iss(line);
-        std::string command;
-        if (!(iss >> command)) {
-            continue;
-        }
-
-        try {
-            if (command == "ADD") {
-                processAddCommand(iss, container);
-            }
-            else if (command == "REM") {
-                processRemoveCommand(iss, container);
-            }
-            else if (command == "PRINT") {
-                container.printAll();
-            }
-            else {
-                std::cout << "Error: Unknown command '" << command << "' at line " << lineNumber << std::endl;
-            }
-        }
-        catch (const std::exception& e) {
-            std::cout << "Error processing command at line " << lineNumber << ": " << e.what() << std::endl;
-        }
-        catch (...) {
-            std::cout << "Unknown error processing command at line " << lineNumber << std::endl;
-        }
-    }
-    std::cout << "Finished processing file. Total films in container: " << container.size() << std::endl;
-}
-
+#include "Commands.h"
+#include "CommandReader.h"
+#include "ThreadPool.h"
+#include <atomic>
 
 TEST(CreateFilmTest, CreateGameFilm) {
     auto film = createFilm("game", "The Matrix", "Wachowski");
@@ -259,3 +96,286 @@ TEST(FileProcessingTest, InvalidFile) {
 
     EXPECT_TRUE(output.find("Error: Cannot open file") != std::string::npos);
 }
+
+TEST(CommandReaderTest, ReadsLines) {
+    const std::string testFilename = "test_reader.txt";
+    std::ofstream testFile(testFilename, std::ios::binary);
+    testFile << "# comment\n\nADD game A|B\r\n   \nPRINT";
+    testFile.close();
+
+    // Отображение в память и буферизованное чтение должны выдавать одинаковые строки
+    for (bool allowMapping : {true, false}) {
+        CommandReader reader(testFilename, allowMapping);
+        ASSERT_TRUE(reader.isOpen());
+        EXPECT_EQ(reader.isMapped(), allowMapping);
+
+        std::vector<std::string> lines;
+        std::string_view line;
+        while (reader.nextLine(line)) {
+            lines.emplace_back(line);
+        }
+        std::vector<std::string> expected = {"# comment", "", "ADD game A|B\r", "   ", "PRINT"};
+        EXPECT_EQ(lines, expected);
+    }
+
+    std::remove(testFilename.c_str());
+}
+
+TEST(CommandReaderTest, LongLinesWithoutMapping) {
+    const std::string testFilename = "test_reader_long.txt";
+    std::string longTitle(200000, 'x');
+    std::ofstream testFile(testFilename, std::ios::binary);
+    testFile << "ADD game " << longTitle << "|D\nPRINT\n";
+    testFile.close();
+
+    CommandReader reader(testFilename, false);
+    std::string_view line;
+    ASSERT_TRUE(reader.nextLine(line));
+    EXPECT_EQ(line.size(), longTitle.size() + 11);
+    ASSERT_TRUE(reader.nextLine(line));
+    EXPECT_EQ(line, "PRINT");
+    EXPECT_FALSE(reader.nextLine(line));
+
+    std::remove(testFilename.c_str());
+}
+
+TEST(CommandReaderTest, MissingFile) {
+    CommandReader reader("non_existent_file.txt");
+    EXPECT_FALSE(reader.isOpen());
+    std::string_view line;
+    EXPECT_FALSE(reader.nextLine(line));
+}
+
+TEST(ParseAddCommandTest, ParsesRecord) {
+    AddRecord record;
+    std::string error;
+    ASSERT_TRUE(parseAddCommand(" series  \"Breaking Bad\"| Vince Gilligan |62", record, error));
+    EXPECT_EQ(record.type, FilmType::Series);
+    EXPECT_EQ(record.title, "Breaking Bad");
+    EXPECT_EQ(record.director, "Vince Gilligan");
+    EXPECT_EQ(record.episodes, 62);
+
+    ASSERT_TRUE(parseAddCommand("cartoon Shrek|puppet", record, error));
+    EXPECT_EQ(record.type, FilmType::Cartoon);
+    EXPECT_EQ(record.creation, TypeCreation::Doll);
+
+    auto film = createFilm(record);
+    EXPECT_EQ(film->getType(), "cartoon");
+    EXPECT_EQ(film->getTitle(), "Shrek");
+}
+
+TEST(ParseAddCommandTest, ErrorMessages) {
+    // Тексты ошибок должны совпадать с прежним разбором побайтно
+    std::pair<const char*, const char*> cases[] = {
+        {"", "Error: Missing film type after ADD command"},
+        {"game   ", "Error: Missing title for ADD command. Format: ADD type title|additional_data"},
+        {"movie X|Y", "Error: Unknown film type 'movie'. Use: cartoon, game, or series"},
+        {"cartoon Shrek|clay", "Error: Invalid animation type. Use: drawn, puppet, or plasticine"},
+        {"cartoon |drawn", "Error creating film: Film type and title cannot be empty"},
+        {"game Matrix|", "Error creating film: Director cannot be empty for game film"},
+        {"game \"\"|Nolan", "Error creating film: Film type and title cannot be empty"},
+        {"series Lost|Abrams|abc", "Error: Invalid episode count 'abc'. Must be a number"},
+        {"series Lost|Abrams|99999999999", "Error: Invalid episode count '99999999999'. Must be a number"},
+        {"series Lost|Abrams", "Error: Invalid episode count ''. Must be a number"},
+        {"series Lost|Abrams|-3", "Error: Episode count must be positive"},
+        {"series Lost| \t |5", "Error creating film: Director cannot be empty for series film"},
+    };
+    for (const auto& [arguments, message] : cases) {
+        AddRecord record;
+        std::string error;
+        EXPECT_FALSE(parseAddCommand(arguments, record, error)) << arguments;
+        EXPECT_EQ(error, message) << arguments;
+    }
+}
+
+TEST(ThreadPoolTest, CoversWholeRange) {
+    ThreadPool pool(4);
+    EXPECT_EQ(pool.size(), 4u);
+    for (size_t count : {0, 1, 7, 10000}) {
+        std::vector<int> hits(count, 0);
+        std::atomic<size_t> total{0};
+        pool.parallelFor(count, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                hits[i]++;
+            }
+            total += end - begin;
+        });
+        EXPECT_EQ(total.load(), count);
+        EXPECT_EQ(std::count(hits.begin(), hits.end(), 1), static_cast<long>(count));
+    }
+}
+
+TEST(FileProcessingTest, ParallelMatchesSequential) {
+    const std::string testFilename = "test_parallel.txt";
+    std::ofstream testFile(testFilename);
+    for (int i = 0; i < 5000; ++i) {
+        testFile << "ADD series Show" << i << "|Director" << i % 7 << "|" << i % 300 << "\n";
+        testFile << "ADD game Game" << i << "|" << (i % 11 == 0 ? "" : "Studio") << "\n";
+        if (i % 997 == 0) {
+            testFile << "REM episodes > 150\nBAD command\n";
+        }
+    }
+    testFile << "PRINT\n";
+    testFile.close();
+
+    std::string outputs[2];
+    size_t sizes[2];
+    unsigned threads[2] = {1, 4};
+    for (int i = 0; i < 2; ++i) {
+        FilmContainer container;
+        CommandOptions options;
+        options.threads = threads[i];
+        testing::internal::CaptureStdout();
+        commandFromFile(testFilename, container, options);
+        outputs[i] = testing::internal::GetCapturedStdout();
+        sizes[i] = container.size();
+    }
+    EXPECT_EQ(outputs[0], outputs[1]);
+    EXPECT_EQ(sizes[0], sizes[1]);
+
+    std::remove(testFilename.c_str());
+}
+
+TEST(FileProcessingTest, BatchAdds) {
+    const std::string testFilename = "test_batch.txt";
+    std::ofstream testFile(testFilename);
+    testFile << "ADD game Matrix|Wachowski\n";
+    testFile << "ADD cartoon Shrek|clay\n";
+    testFile << "ADD cartoon Shrek|drawn\n";
+    testFile << "REM type == game\n";
+    testFile << "ADD series Lost|Abrams|121\n";
+    testFile.close();
+
+    FilmContainer container;
+    CommandOptions options;
+    options.threads = 1;
+    options.batchAdds = true;
+    testing::internal::CaptureStdout();
+    commandFromFile(testFilename, container, options);
+    std::string output = testing::internal::GetCapturedStdout();
+
+    EXPECT_EQ(output,
+        "Error: Invalid animation type. Use: drawn, puppet, or plasticine\n"
+        "Added 2 film(s) successfully\n"
+        "Successfully removed 1 film(s)\n"
+        "Added 1 film(s) successfully\n"
+        "Finished processing file. Total films in container: 2\n");
+
+    std::remove(testFilename.c_str());
+}
+
+// Считает сбросы, чтобы проверить, что серия ADD сбрасывает вывод один раз
+class CountingOutputSink : public BufferOutputSink
+{
+public:
+    size_t flushes = 0;
+
+    void flush() override {
+        ++flushes;
+    }
+};
+
+TEST(FileProcessingTest, AddRunFlushesOnce) {
+    const std::string testFilename = "test_flushes.txt";
+    std::ofstream testFile(testFilename);
+    for (int i = 0; i < 1000; ++i) {
+        testFile << "ADD game Game" << i << "|Studio\n";
+    }
+    testFile << "REM title == Game7\n";
+    for (int i = 0; i < 500; ++i) {
+        testFile << "ADD cartoon Cartoon" << i << "|" << (i == 250 ? "clay" : "drawn") << "\n";
+    }
+    testFile.close();
+
+    unsigned threads[2] = {1, 4};
+    for (unsigned count : threads) {
+        CountingOutputSink output;
+        FilmContainer container(output);
+        CommandOptions options;
+        options.threads = count;
+        commandFromFile(testFilename, container, options);
+        // Серия ADD, REM и итоговая строка; ошибка в серии не добавляет сброса
+        EXPECT_EQ(output.flushes, 3) << count;
+        EXPECT_EQ(container.size(), 1498);
+        EXPECT_NE(output.str().find("Error: Invalid animation type"), std::string::npos);
+    }
+
+    // Отдельная команда ADD сбрасывает вывод и при ошибке
+    CountingOutputSink output;
+    FilmContainer container(output);
+    processAddCommand("cartoon Shrek|clay", container);
+    processAddCommand("cartoon Shrek|drawn", container);
+    EXPECT_EQ(output.flushes, 2);
+
+    std::remove(testFilename.c_str());
+}
+
+TEST(FileProcessingTest, RemoveById) {
+    const std::string testFilename = "test_ids.txt";
+    std::ofstream testFile(testFilename);
+    testFile << "ADD game Matrix|Wachowski\n";
+    testFile << "ADD cartoon Shrek|drawn\n";
+    testFile << "REM id == 0\n";
+    testFile << "REM id == 0\n";
+    testFile << "PRINT ids\n";
+    testFile << "PRINT all\n";
+    testFile.close();
+
+    FilmContainer container;
+    CommandOptions options;
+    options.threads = 1;
+    testing::internal::CaptureStdout();
+    commandFromFile(testFilename, container, options);
+    std::string output = testing::internal::GetCapturedStdout();
+
+    EXPECT_EQ(output,
+        "Film added successfully\n"
+        "Film added successfully\n"
+        "Successfully removed 1 film(s)\n"
+        "Successfully removed 0 film(s)\n"
+        "Films in container (1 total):\n"
+        "1. [id 1] Cartoon film: Shrek, animation type: drawn\n"
+        "Error: Unknown PRINT option 'all'\n"
+        "Finished processing file. Total films in container: 1\n");
+
+    std::remove(testFilename.c_str());
+}
+
+TEST(FileProcessingTest, FindAndCount) {
+    const std::string testFilename = "test_find.txt";
+    std::ofstream testFile(testFilename);
+    testFile << "ADD game Matrix|Wachowski\n";
+    testFile << "ADD series Sense8|Wachowski|24\n";
+    testFile << "ADD cartoon Shrek|drawn\n";
+    testFile << "FIND director == Wachowski LIMIT 1\n";
+    testFile << "FIND NOT type == cartoon\n";
+    testFile << "COUNT director == Wachowski OR type == cartoon\n";
+    testFile << "FIND title == Shrek LIMIT 0\n";
+    testFile << "FIND LIMIT 2\n";
+    testFile << "COUNT\n";
+    testFile.close();
+
+    FilmContainer container;
+    CommandOptions options;
+    options.threads = 1;
+    testing::internal::CaptureStdout();
+    commandFromFile(testFilename, container, options);
+    std::string output = testing::internal::GetCapturedStdout();
+
+    EXPECT_EQ(output,
+        "Film added successfully\n"
+        "Film added successfully\n"
+        "Film added successfully\n"
+        "1. Game film: Matrix, director: Wachowski\n"
+        "Found 1 film(s)\n"
+        "1. Game film: Matrix, director: Wachowski\n"
+        "2. Series film: Sense8, director: Wachowski, episodes: 24\n"
+        "Found 2 film(s)\n"
+        "Counted 3 film(s)\n"
+        "Error: LIMIT must be a positive number\n"
+        "Error: Missing condition for FIND command\n"
+        "Error: Missing condition for COUNT command\n"
+        "Finished processing file. Total films in container: 3\n");
+
+    std::remove(testFilename.c_str());
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include "Condition.h"
+#include "ConditionExpression.h"
+#include "FilmContainer.h"
+#include "GameFilm.h"
+#include "CartoonFilm.h"
+#include "SeriesFilm.h"
+
+TEST(ConditionTest, Compile) {
+    Condition condition = Condition::compile("director ==  Christopher Nolan \t");
+    EXPECT_EQ(condition.getField(), ConditionField::Director);
+    EXPECT_EQ(condition.getOp(), ConditionOp::Equal);
+    EXPECT_EQ(condition.getValue(), "Christopher Nolan");
+
+    EXPECT_EQ(Condition::compile("episodes >= 10").getOp(), ConditionOp::GreaterEqual);
+    EXPECT_EQ(Condition::compile("budget == 10").getField(), ConditionField::Unknown);
+    EXPECT_EQ(Condition::compile("title like Shrek").getOp(), ConditionOp::Unknown);
+    EXPECT_EQ(Condition::compile("").getField(), ConditionField::Unknown);
+}
+
+TEST(ConditionTest, MatchesSameAsString) {
+    GameFilm game("Inception", "Christopher Nolan");
+    CartoonFilm cartoon("Shrek", TypeCreation::Doll);
+    SeriesFilm series("Friends", "David Crane", 236);
+
+    // Скомпилированное условие должно давать тот же результат, что и строковое
+    const char* conditions[] = {
+        "title == Shrek", "title != Shrek", "title contains i",
+        "director == David Crane", "director contains Nolan",
+        "animation_type == puppet", "animation_type != doll", "animation_type == clay",
+        "episodes > 100", "episodes <= 236", "episodes == abc", "episodes contains 2",
+        "type == series", "type != game", "",
+    };
+    for (const char* text : conditions) {
+        Condition condition = Condition::compile(text);
+        EXPECT_EQ(game.matches(condition), game.matchesCondition(text)) << text;
+        EXPECT_EQ(cartoon.matches(condition), cartoon.matchesCondition(text)) << text;
+        EXPECT_EQ(series.matches(condition), series.matchesCondition(text)) << text;
+    }
+
+    EXPECT_TRUE(cartoon.matches(Condition::compile("animation_type == puppet")));
+    EXPECT_TRUE(series.matches(Condition::compile("episodes > 100")));
+    EXPECT_FALSE(series.matches(Condition::compile("episodes == abc")));
+    EXPECT_FALSE(game.matches(Condition::compile("type != game")));
+}
+
+TEST(ConditionTest, RemoveWithCompiledCondition) {
+    FilmContainer container;
+    container.addFilm(std::make_unique<SeriesFilm>("Friends", "David Crane", 236));
+    container.addFilm(std::make_unique<SeriesFilm>("Sherlock", "Mark Gatiss", 13));
+    container.addFilm(std::make_unique<GameFilm>("Matrix", "Wachowski"));
+
+    testing::internal::CaptureStdout();
+    container.removeFilms(Condition::compile("episodes > 100"));
+    std::string output = testing::internal::GetCapturedStdout();
+    EXPECT_TRUE(output.find("Successfully removed 1 film(s)") != std::string::npos);
+    EXPECT_EQ(container.size(), 2);
+}
+
+TEST(ConditionExpressionTest, ParsesBooleanOperators) {
+    ConditionExpression single = ConditionExpression::compile("director ==  Christopher Nolan \t");
+    ASSERT_TRUE(single.isSingle());
+    EXPECT_EQ(single.getSingle().getValue(), "Christopher Nolan");
+
+    // Текст, не разбирающийся как выражение, остается одним условием
+    ConditionExpression legacy = ConditionExpression::compile("title == Tom AND Jerry");
+    ASSERT_TRUE(legacy.isSingle());
+    EXPECT_EQ(legacy.getSingle().getValue(), "Tom AND Jerry");
+    EXPECT_TRUE(ConditionExpression::compile("title == Film (2001)").isSingle());
+
+    ConditionExpression compound = ConditionExpression::compile(
+        "(title contains Lost OR director == Abrams) AND NOT episodes > 100 AND type == series");
+    EXPECT_FALSE(compound.isSingle());
+    ASSERT_EQ(compound.getConditions().size(), 4u);
+    EXPECT_EQ(compound.getConditions()[1].getValue(), "Abrams");
+
+    ConditionExpression nested = ConditionExpression::compile("(title == Film (2001)) OR title == X");
+    ASSERT_EQ(nested.getConditions().size(), 2u);
+    EXPECT_EQ(nested.getConditions()[0].getValue(), "Film (2001)");
+}
+
+TEST(ConditionExpressionTest, MatchesLikeSeparateConditions) {
+    GameFilm game("Inception", "Christopher Nolan");
+    CartoonFilm cartoon("Shrek", TypeCreation::Doll);
+    SeriesFilm series("Friends", "David Crane", 236);
+    const Film* films[] = { &game, &cartoon, &series };
+
+    for (const Film* film : films) {
+        bool nolan = film->matchesCondition("director contains Nolan");
+        bool longSeries = film->matchesCondition("episodes > 100");
+        bool shrek = film->matchesCondition("title == Shrek");
+        EXPECT_EQ(ConditionExpression::compile("director contains Nolan OR episodes > 100").matches(*film), nolan || longSeries);
+        EXPECT_EQ(ConditionExpression::compile("NOT (director contains Nolan OR title == Shrek)").matches(*film), !(nolan || shrek));
+        EXPECT_EQ(ConditionExpression::compile("type != game AND NOT episodes > 100 AND NOT title == Shrek").matches(*film),
+            film->matchesCondition("type != game") && !longSeries && !shrek);
+    }
+}
+
+TEST(ConditionExpressionTest, ShortCircuitsCheapClausesFirst) {
+    ConditionExpression expression = ConditionExpression::compile("title contains a AND episodes > 5 AND type == series");
+    std::vector<ConditionField> checked;
+    bool matched = expression.evaluate([&checked](const Condition& condition) {
+        checked.push_back(condition.getField());
+        return condition.getField() != ConditionField::Type;
+    });
+    // type проверяется первым и сразу дает ложь, остальные условия не вычисляются
+    EXPECT_FALSE(matched);
+    ASSERT_EQ(checked.size(), 1u);
+    EXPECT_EQ(checked[0], ConditionField::Type);
+}
+
+TEST(ConditionExpressionTest, RemoveInOnePass) {
+    BufferOutputSink buffer;
+    FilmContainer container(buffer);
+    container.setEpisodeIndex(true);
+    FilmId lost = container.addFilm(std::make_unique<SeriesFilm>("Lost", "Abrams", 121));
+    container.addFilm(std::make_unique<SeriesFilm>("Alias", "Abrams", 105));
+    container.addFilm(std::make_unique<SeriesFilm>("Fringe", "Abrams", 100));
+    container.addFilm(std::make_unique<GameFilm>("Star Trek", "Abrams"));
+    container.addFilm(std::make_unique<CartoonFilm>("Shrek", TypeCreation::Drawn));
+
+    buffer.clear();
+    container.removeFilms("director == Abrams AND episodes > 100 AND NOT id == " + std::to_string(lost));
+    container.removeFilms("(type == cartoon OR title contains Trek) AND id != 0");
+    container.removeFilms("title == Lost AND id > 0");
+    EXPECT_EQ(buffer.str(), "Successfully removed 1 film(s)\n"
+        "Successfully removed 2 film(s)\n"
+        "Error removing films: id condition must have the form 'id == N' or 'id != N'\n");
+
+    buffer.clear();
+    container.printAll();
+    EXPECT_EQ(buffer.str(), "Films in container (2 total):\n"
+        "1. Series film: Lost, director: Abrams, episodes: 121\n"
+        "2. Series film: Fringe, director: Abrams, episodes: 100\n");
+}
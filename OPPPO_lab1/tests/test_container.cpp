@@ -3,6 +3,44 @@
 #include "GameFilm.h"
 #include "CartoonFilm.h"
 #include "SeriesFilm.h"
+#include "OutputSink.h"
+#include "FilmIndex.h"
+#include "Condition.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory_resource>
+
+// Контейнер со своим выводом для сравнения путей удаления
+struct RecordedContainer
+{
+    BufferOutputSink output;
+    FilmContainer container{ output };
+};
+
+// Заполняет контейнеры через fill и после каждого условия сравнивает вывод и размер каждого с первым
+static void expectSameRemovals(const std::vector<RecordedContainer*>& runs,
+    const std::function<void(FilmContainer&)>& fill, const std::vector<std::string>& conditions) {
+    for (RecordedContainer* run : runs) {
+        fill(run->container);
+    }
+    for (const std::string& condition : conditions) {
+        for (RecordedContainer* run : runs) {
+            run->container.removeFilms(condition);
+            run->container.printAll();
+        }
+        for (size_t i = 1; i < runs.size(); ++i) {
+            EXPECT_EQ(runs[0]->output.str(), runs[i]->output.str()) << condition;
+            EXPECT_EQ(runs[0]->container.size(), runs[i]->container.size()) << condition;
+        }
+    }
+}
+
+static std::vector<const Film*> sortedFilms(std::vector<const Film*> films) {
+    std::sort(films.begin(), films.end());
+    return films;
+}
 
 TEST(FilmContainerTest, AddAndSize) {
     FilmContainer container;
@@ -18,11 +56,10 @@ TEST(FilmContainerTest, AddAndSize) {
 }
 
 TEST(FilmContainerTest, AddNullFilm) {
-    FilmContainer container;
-    testing::internal::CaptureStdout();
+    BufferOutputSink output;
+    FilmContainer container(output);
     container.addFilm(nullptr);
-    std::string output = testing::internal::GetCapturedStdout();
-    EXPECT_TRUE(output.find("Error: Cannot add null film") != std::string::npos);
+    EXPECT_TRUE(output.str().find("Error: Cannot add null film") != std::string::npos);
 }
 
 TEST(FilmContainerTest, RemoveFilms) {
@@ -74,21 +111,613 @@ TEST(FilmContainerTest, PrintAll) {
 }
 
 TEST(FilmContainerTest, ValidateAddCommand) {
+    BufferOutputSink output;
 
     std::vector<std::string> cartoonParams = {"Shrek", "drawn"};
-    EXPECT_TRUE(FilmContainer::validateAddCommand("cartoon", cartoonParams));
+    EXPECT_TRUE(FilmContainer::validateAddCommand("cartoon", cartoonParams, output));
 
     std::vector<std::string> gameParams = {"Matrix", "Wachowski"};
-    EXPECT_TRUE(FilmContainer::validateAddCommand("game", gameParams));
+    EXPECT_TRUE(FilmContainer::validateAddCommand("game", gameParams, output));
 
     std::vector<std::string> seriesParams = {"Breaking Bad", "Vince Gilligan", "62"};
-    EXPECT_TRUE(FilmContainer::validateAddCommand("series", seriesParams));
+    EXPECT_TRUE(FilmContainer::validateAddCommand("series", seriesParams, output));
 
     std::vector<std::string> invalidCartoon = {"Shrek", "invalid_type"};
-    EXPECT_FALSE(FilmContainer::validateAddCommand("cartoon", invalidCartoon));
+    EXPECT_FALSE(FilmContainer::validateAddCommand("cartoon", invalidCartoon, output));
     std::vector<std::string> invalidSeries = {"Breaking Bad", "Vince Gilligan", "not_a_number"};
-    EXPECT_FALSE(FilmContainer::validateAddCommand("series", invalidSeries));
+    EXPECT_FALSE(FilmContainer::validateAddCommand("series", invalidSeries, output));
 
     std::vector<std::string> emptyParams;
-    EXPECT_FALSE(FilmContainer::validateAddCommand("unknown_type", emptyParams));
+    EXPECT_FALSE(FilmContainer::validateAddCommand("unknown_type", emptyParams, output));
+    EXPECT_EQ(output.str(), "Error: Invalid animation type. Use: drawn, puppet, or plasticine\n"
+        "Error: Invalid episode count 'not_a_number'. Must be a number\n"
+        "Error: Unknown film type 'unknown_type'. Use: cartoon, game, or series\n");
+}
+
+TEST(FilmContainerTest, AddFilmsBatch) {
+    FilmContainer container;
+    std::vector<std::unique_ptr<Film>> batch;
+    batch.push_back(std::make_unique<GameFilm>("Matrix", "Wachowski"));
+    batch.push_back(nullptr);
+    batch.push_back(std::make_unique<SeriesFilm>("Lost", "Abrams", 121));
+
+    testing::internal::CaptureStdout();
+    container.addFilms(std::move(batch));
+    std::string output = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(output, "Error: Cannot add 1 null film(s)\nAdded 2 film(s) successfully\n");
+    EXPECT_EQ(container.size(), 2);
+
+    // Генератор с известным числом элементов
+    testing::internal::CaptureStdout();
+    container.addFilms(1000, [](size_t i) {
+        return std::make_unique<CartoonFilm>("Cartoon" + std::to_string(i), TypeCreation::Drawn);
+    });
+    output = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(output, "Added 1000 film(s) successfully\n");
+    EXPECT_EQ(container.size(), 1002);
+}
+
+TEST(FilmContainerTest, OutputSinks) {
+    BufferOutputSink buffer;
+    FilmContainer container(buffer);
+    container.addFilm(std::make_unique<SeriesFilm>("Lost", "Abrams", 121));
+    container.printAll();
+    EXPECT_EQ(buffer.str(), "Film added successfully\n"
+        "Films in container (1 total):\n"
+        "1. Series film: Lost, director: Abrams, episodes: 121\n");
+
+    // Вывод можно переключить или заглушить
+    NullOutputSink null;
+    container.setOutput(null);
+    container.removeFilms("title == Lost");
+    EXPECT_EQ(container.size(), 0);
+    EXPECT_EQ(&container.getOutput(), &null);
+
+    const std::string filename = "test_sink.txt";
+    {
+        FileOutputSink file(filename);
+        ASSERT_TRUE(file.isOpen());
+        container.setOutput(file);
+        container.printAll();
+    }
+    std::ifstream input(filename);
+    std::string line;
+    std::getline(input, line);
+    EXPECT_EQ(line, "Container is empty");
+    input.close();
+    std::remove(filename.c_str());
+}
+
+TEST(FilmContainerTest, TitleIndexMatchesScan) {
+    RecordedContainer scan;
+    RecordedContainer indexed;
+    indexed.container.setTitleIndex(true);
+    EXPECT_TRUE(indexed.container.hasTitleIndex());
+
+    expectSameRemovals({ &scan, &indexed }, [](FilmContainer& container) {
+        for (int i = 0; i < 200; ++i) {
+            // Названия повторяются, чтобы одно удаление задевало несколько фильмов
+            container.addFilm(std::make_unique<SeriesFilm>("Film" + std::to_string(i % 50), "Director", i + 1));
+        }
+        std::vector<std::unique_ptr<Film>> batch;
+        batch.push_back(std::make_unique<GameFilm>("Film7", "Nolan"));
+        container.addFilms(std::move(batch));
+    }, {
+        "title == Film7", "title == Film7", "title == Missing", "episodes > 150",
+        "title == Film0", "title != Film1", "title == Film1",
+    });
+    EXPECT_EQ(indexed.container.size(), 0);
+    EXPECT_GT(indexed.container.getIndexPlanCount(), 0u);
+
+    // Индекс можно включить на уже заполненном контейнере
+    scan.container.addFilm(std::make_unique<GameFilm>("Late", "Nolan"));
+    scan.container.setTitleIndex(true);
+    scan.container.removeFilms("title == Late");
+    EXPECT_EQ(scan.container.size(), 0);
+
+    GameFilm game("Film7", "Nolan");
+    SeriesFilm series("Film7", "Lynch", 3);
+    GameFilm other("Film70", "Nolan");
+    FilmStringIndex index(filmTitle);
+    index.insert(game);
+    index.insert(series);
+    index.insert(other);
+    EXPECT_EQ(sortedFilms(index.find("Film7")), sortedFilms({ &game, &series }));
+    index.erase({ &game });
+    EXPECT_EQ(index.find("Film7"), std::vector<const Film*>{ &series });
+    EXPECT_EQ(index.count("Film70"), 1u);
+}
+
+TEST(FilmContainerTest, DirectorIndexMatchesScan) {
+    RecordedContainer scan;
+    RecordedContainer indexed;
+    indexed.container.setDirectorIndex(true);
+    EXPECT_TRUE(indexed.container.hasDirectorIndex());
+
+    // Мультфильмы без режиссера в индекс не попадают
+    expectSameRemovals({ &scan, &indexed }, [](FilmContainer& container) {
+        for (int i = 0; i < 120; ++i) {
+            std::string director = "Director" + std::to_string(i % 6);
+            switch (i % 3) {
+            case 0: container.addFilm(std::make_unique<GameFilm>("Game" + std::to_string(i), director)); break;
+            case 1: container.addFilm(std::make_unique<CartoonFilm>("Director1", TypeCreation::Drawn)); break;
+            default: container.addFilm(std::make_unique<SeriesFilm>("Series" + std::to_string(i), director, i)); break;
+            }
+        }
+    }, {
+        "director == Director1", "director == Director1", "director == Nobody",
+        "title contains 5", "director != Director2", "director == Director2",
+    });
+    EXPECT_EQ(indexed.container.size(), 40);
+    EXPECT_GT(indexed.container.getIndexPlanCount(), 0u);
+
+    GameFilm game("Heat", "Mann");
+    SeriesFilm series("Miami Vice", "Mann", 111);
+    CartoonFilm cartoon("Mann", TypeCreation::Drawn);
+    FilmStringIndex index(filmDirector);
+    index.insert(game);
+    index.insert(series);
+    index.insert(cartoon);
+    EXPECT_EQ(sortedFilms(index.find("Mann")), sortedFilms({ &game, &series }));
+    EXPECT_EQ(index.size(), 2u);
+}
+
+TEST(FilmContainerTest, EpisodeIndexMatchesScan) {
+    RecordedContainer scan;
+    RecordedContainer indexed;
+    indexed.container.setEpisodeIndex(true);
+    EXPECT_TRUE(indexed.container.hasEpisodeIndex());
+
+    // Каждый оператор сравнения, включая нечисловое значение
+    expectSameRemovals({ &scan, &indexed }, [](FilmContainer& container) {
+        for (int i = 0; i < 150; ++i) {
+            if (i % 5 == 0) {
+                container.addFilm(std::make_unique<GameFilm>("Game" + std::to_string(i), "Nolan"));
+            }
+            else {
+                container.addFilm(std::make_unique<SeriesFilm>("Series" + std::to_string(i), "Crane", i % 40 + 1));
+            }
+        }
+    }, {
+        "episodes > 35", "episodes >= 33", "episodes < 3", "episodes <= 4", "episodes == 10",
+        "episodes == 10", "episodes != 20", "episodes > many", "episodes contains 1", "episodes == 20",
+    });
+    EXPECT_EQ(indexed.container.size(), 30);
+    EXPECT_GT(indexed.container.getIndexPlanCount(), 0u);
+
+    SeriesFilm shortSeries("Short", "Crane", 5);
+    SeriesFilm first("First", "Crane", 10);
+    SeriesFilm second("Second", "Crane", 10);
+    GameFilm game("Game", "Nolan");
+    EpisodeIndex index;
+    index.insert(shortSeries);
+    index.insert(first);
+    index.insert(second);
+    index.insert(game);
+    EXPECT_EQ(sortedFilms(index.find(Condition::compile("episodes >= 10"))), sortedFilms({ &first, &second }));
+    EXPECT_EQ(index.find(Condition::compile("episodes < 10")), std::vector<const Film*>{ &shortSeries });
+    EXPECT_TRUE(index.find(Condition::compile("episodes > many")).empty());
+}
+
+TEST(FilmContainerTest, TrigramIndexMatchesScan) {
+    RecordedContainer scan;
+    RecordedContainer indexed;
+    indexed.container.setTrigramIndex(true);
+    EXPECT_TRUE(indexed.container.hasTrigramIndex());
+
+    // Короткие подстроки проверяются полным перебором, длинные - через индекс
+    expectSameRemovals({ &scan, &indexed }, [](FilmContainer& container) {
+        const char* words[] = {"Matrix", "Marvel", "Mars", "Atlas", "Tarantino", "Star"};
+        for (int i = 0; i < 240; ++i) {
+            std::string title = std::string(words[i % 6]) + " " + std::to_string(i);
+            std::string director = words[(i / 6) % 6];
+            switch (i % 3) {
+            case 0: container.addFilm(std::make_unique<GameFilm>(title, director)); break;
+            case 1: container.addFilm(std::make_unique<CartoonFilm>(title, TypeCreation::Doll)); break;
+            default: container.addFilm(std::make_unique<SeriesFilm>(title, director, i)); break;
+            }
+        }
+    }, {
+        "title contains arv", "title contains Zzz", "director contains tar", "title contains 1",
+        "director contains ar", "title contains Mars 1", "title contains 5", "director contains Tarantino",
+        "title contains ", "director contains Star",
+    });
+    EXPECT_GT(indexed.container.getIndexPlanCount(), 0u);
+
+    // Освобожденные адреса могут достаться новым фильмам, старые записи индекса не должны их находить
+    for (RecordedContainer* run : { &scan, &indexed }) {
+        run->container.addFilm(std::make_unique<GameFilm>("Fresh", "Nobody"));
+        run->container.removeFilms("title contains Matrix");
+        run->container.removeFilms("title contains Fresh");
+        run->container.printAll();
+    }
+    EXPECT_EQ(scan.output.str(), indexed.output.str());
+
+    GameFilm matrix("Matrix", "Wachowski");
+    GameFilm marvel("Marvel", "Feige");
+    CartoonFilm mars("Mars", TypeCreation::Doll);
+    TrigramIndex index(filmTitle);
+    index.insert(matrix);
+    index.insert(marvel);
+    index.insert(mars);
+    std::vector<const Film*> found;
+    ASSERT_TRUE(index.find("Mar", found));
+    EXPECT_EQ(sortedFilms(found), sortedFilms({ &marvel, &mars }));
+    index.erase({ &marvel });
+    ASSERT_TRUE(index.find("arv", found));
+    EXPECT_TRUE(found.empty());
+    ASSERT_TRUE(index.find("ars", found));
+    EXPECT_EQ(found, std::vector<const Film*>{ &mars });
+    EXPECT_FALSE(index.find("ar", found));
+}
+
+TEST(FilmContainerTest, TypePartitionsKeepInsertionOrder) {
+    BufferOutputSink buffer;
+    FilmContainer container(buffer);
+    container.addFilm(std::make_unique<CartoonFilm>("Shrek", TypeCreation::Drawn));
+    container.addFilm(std::make_unique<GameFilm>("Inception", "Nolan"));
+    container.addFilm(std::make_unique<SeriesFilm>("Lost", "Abrams", 121));
+    container.addFilm(std::make_unique<CartoonFilm>("Coraline", TypeCreation::Doll));
+    container.addFilm(std::make_unique<GameFilm>("Tenet", "Nolan"));
+
+    // Удаление целого типа не меняет порядок остальных
+    container.removeFilms("type == cartoon");
+    container.removeFilms("type != game");
+    container.removeFilms("type == movie");
+    buffer.clear();
+    container.printAll();
+    EXPECT_EQ(buffer.str(), "Films in container (3 total):\n"
+        "1. Game film: Inception, director: Nolan\n"
+        "2. Series film: Lost, director: Abrams, episodes: 121\n"
+        "3. Game film: Tenet, director: Nolan\n");
+
+    // Условие по режиссеру просматривает только игры и сериалы
+    container.addFilm(std::make_unique<CartoonFilm>("Nolan", TypeCreation::Plasticine));
+    container.removeFilms("director == Nolan");
+    container.removeFilms("episodes > 100");
+    buffer.clear();
+    container.printAll();
+    EXPECT_EQ(buffer.str(), "Films in container (1 total):\n"
+        "1. Cartoon film: Nolan, animation type: plasticine\n");
+}
+
+TEST(FilmContainerTest, TombstonesMatchEagerRemoval) {
+    RecordedContainer eager;
+    RecordedContainer lazy;
+    RecordedContainer indexed;
+    lazy.container.setCompactionThreshold(0.5);
+    indexed.container.setCompactionThreshold(0.5);
+    indexed.container.setTitleIndex(true);
+    indexed.container.setEpisodeIndex(true);
+
+    expectSameRemovals({ &eager, &lazy, &indexed }, [](FilmContainer& container) {
+        for (int i = 0; i < 120; ++i) {
+            std::string title = "Film" + std::to_string(i % 30);
+            container.addFilm(std::make_unique<SeriesFilm>(title, "Director", i + 1));
+            if (i % 4 == 0) {
+                container.addFilm(std::make_unique<GameFilm>(title, "Nolan"));
+            }
+        }
+    }, {
+        "title == Film3", "episodes < 10", "director == Nolan", "title == Film4",
+        "episodes >= 100", "title contains 1", "type == game", "title != Film5",
+    });
+    EXPECT_EQ(eager.container.getTombstoneCount(), 0u);
+
+    // Остаются сериалы Film5 на 36, 66 и 96 серий; сериал на 6 серий ушел с episodes < 10
+    lazy.output.clear();
+    lazy.container.printAll();
+    EXPECT_EQ(lazy.output.str(), "Films in container (3 total):\n"
+        "1. Series film: Film5, director: Director, episodes: 36\n"
+        "2. Series film: Film5, director: Director, episodes: 66\n"
+        "3. Series film: Film5, director: Director, episodes: 96\n");
+
+    // Новые фильмы встают после уцелевших, а понижение порога уплотняет сразу
+    lazy.container.addFilm(std::make_unique<GameFilm>("Late", "Nolan"));
+    eager.container.addFilm(std::make_unique<GameFilm>("Late", "Nolan"));
+    lazy.container.setCompactionThreshold(0.0);
+    EXPECT_EQ(lazy.container.getTombstoneCount(), 0u);
+    eager.output.clear();
+    lazy.output.clear();
+    eager.container.printAll();
+    lazy.container.printAll();
+    EXPECT_EQ(eager.output.str(), lazy.output.str());
+}
+
+TEST(FilmContainerTest, TombstonesDeferCompaction) {
+    BufferOutputSink buffer;
+    FilmContainer container(buffer);
+    container.setCompactionThreshold(0.5);
+    for (int i = 0; i < 10; ++i) {
+        container.addFilm(std::make_unique<SeriesFilm>("Film" + std::to_string(i), "Director", i + 1));
+    }
+
+    // Четыре удаления из десяти не превышают порог и остаются надгробиями
+    container.removeFilms("episodes <= 4");
+    EXPECT_EQ(container.size(), 6u);
+    EXPECT_EQ(container.getTombstoneCount(), 4u);
+
+    // Шестое удаление превышает порог, раздел уплотняется
+    container.removeFilms("episodes <= 6");
+    EXPECT_EQ(container.size(), 4u);
+    EXPECT_EQ(container.getTombstoneCount(), 0u);
+
+    container.removeFilms("episodes < 100");
+    EXPECT_EQ(container.size(), 0u);
+    EXPECT_EQ(container.getTombstoneCount(), 0u);
+}
+
+TEST(FilmContainerTest, ContainsSeesFilmsAddedAfterSearch) {
+    BufferOutputSink buffer;
+    FilmContainer container(buffer);
+    container.setCompactionThreshold(0.5);
+    for (int i = 0; i < 4; ++i) {
+        container.addFilm(std::make_unique<GameFilm>("Mars" + std::to_string(i), "Scott"));
+    }
+    container.addFilm(std::make_unique<GameFilm>("Venus", "Cameron"));
+
+    // Склеенные строки раздела дописываются новыми фильмами и сбрасываются уплотнением
+    container.removeFilms("title contains Mars0");
+    EXPECT_EQ(container.getTombstoneCount(), 1u);
+    container.addFilm(std::make_unique<GameFilm>("Mars0 Returns", "Nolan"));
+    container.removeFilms("title contains Mars0");
+    EXPECT_EQ(container.size(), 4u);
+
+    container.removeFilms("director contains Scott");
+    EXPECT_EQ(container.size(), 1u);
+    EXPECT_EQ(container.getTombstoneCount(), 0u);
+    container.addFilm(std::make_unique<GameFilm>("Mars4", "Scott"));
+    container.removeFilms("title contains Mars");
+    container.removeFilms("director contains Cameron");
+    EXPECT_EQ(container.size(), 0u);
+}
+
+TEST(FilmContainerTest, StableIdsSurviveRemoval) {
+    BufferOutputSink buffer;
+    FilmContainer container(buffer);
+    container.setCompactionThreshold(0.5);
+    container.setTitleIndex(true);
+    FilmId inception = container.addFilm(std::make_unique<GameFilm>("Inception", "Nolan"));
+    FilmId shrek = container.addFilm(std::make_unique<CartoonFilm>("Shrek", TypeCreation::Drawn));
+    FilmId lost = container.addFilm(std::make_unique<SeriesFilm>("Lost", "Abrams", 121));
+    FilmId tenet = container.addFilm(std::make_unique<GameFilm>("Tenet", "Nolan"));
+    EXPECT_EQ(container.addFilm(std::unique_ptr<Film>()), INVALID_FILM_ID);
+
+    // Удаления по условию не меняют идентификаторы остальных фильмов
+    container.removeFilms("title == Inception");
+    EXPECT_FALSE(container.removeFilm(inception));
+    EXPECT_TRUE(container.removeFilm(tenet));
+    EXPECT_FALSE(container.removeFilm(tenet));
+
+    // Освобожденная ячейка выдается с новым поколением, старый идентификатор ее не задевает
+    FilmId matrix = container.addFilm(std::make_unique<GameFilm>("Matrix", "Wachowski"));
+    EXPECT_NE(matrix, inception);
+    EXPECT_NE(matrix, tenet);
+    EXPECT_FALSE(container.removeFilm(inception));
+    EXPECT_EQ(container.size(), 3u);
+
+    buffer.clear();
+    container.printAll(true);
+    EXPECT_EQ(buffer.str(), "Films in container (3 total):\n"
+        "1. [id " + std::to_string(shrek) + "] Cartoon film: Shrek, animation type: drawn\n"
+        "2. [id " + std::to_string(lost) + "] Series film: Lost, director: Abrams, episodes: 121\n"
+        "3. [id " + std::to_string(matrix) + "] Game film: Matrix, director: Wachowski\n");
+
+    buffer.clear();
+    container.removeFilms("id == " + std::to_string(lost));
+    container.removeFilms("id > 1");
+    container.removeFilms("id == -1");
+    EXPECT_EQ(buffer.str(), "Successfully removed 1 film(s)\n"
+        "Error removing films: id condition must have the form 'id == N' or 'id != N'\n"
+        "Error removing films: id condition must have the form 'id == N' or 'id != N'\n");
+    EXPECT_TRUE(container.removeFilm(shrek));
+    container.removeFilms("title == Matrix");
+    EXPECT_EQ(container.size(), 0u);
+}
+
+TEST(FilmContainerTest, PlannerUsesIndexOnlyWhenSelective) {
+    BufferOutputSink scanOutput;
+    BufferOutputSink indexOutput;
+    FilmContainer scan(scanOutput);
+    FilmContainer indexed(indexOutput);
+    indexed.setDirectorIndex(true);
+    indexed.setEpisodeIndex(true);
+
+    for (int i = 0; i < 400; ++i) {
+        std::string director = i % 100 == 0 ? "Rare" : i % 8 == 1 ? "Other" : "Common";
+        scan.addFilm(std::make_unique<SeriesFilm>("Film" + std::to_string(i), director, i + 1));
+        indexed.addFilm(std::make_unique<SeriesFilm>("Film" + std::to_string(i), director, i + 1));
+    }
+    indexed.addFilm(std::make_unique<GameFilm>("Game", "Common"));
+    scan.addFilm(std::make_unique<GameFilm>("Game", "Common"));
+
+    const FilmStatistics* statistics = indexed.getStatistics();
+    ASSERT_NE(statistics, nullptr);
+    EXPECT_EQ(statistics->getTypeCount(FilmType::Series), 400u);
+    EXPECT_EQ(statistics->getDistinctDirectors(), 3u);
+    EXPECT_EQ(statistics->countDirector("Rare"), 4u);
+    // На границах корзин оценка точная, внутри корзины - равномерная
+    EXPECT_NEAR(statistics->estimateEpisodes(Condition::compile("episodes < 128")), 127.0, 0.01);
+    EXPECT_NEAR(statistics->estimateEpisodes(Condition::compile("episodes >= 256")), 145.0, 0.01);
+    EXPECT_NEAR(statistics->estimateEpisodes(Condition::compile("episodes == 300")), 145.0 / 256, 0.01);
+
+    struct Step
+    {
+        const char* condition;
+        size_t indexPlans;
+        size_t scanPlans;
+    };
+    const Step steps[] = {
+        { "director == Rare", 1, 0 },
+        { "director == Common", 1, 1 },
+        { "episodes < 10", 2, 1 },
+        { "episodes > 20", 2, 2 },
+        { "director == Missing AND episodes > 0", 3, 2 },
+        { "episodes != 12 OR title contains Film", 3, 3 },
+    };
+    for (const Step& step : steps) {
+        scan.removeFilms(step.condition);
+        indexed.removeFilms(step.condition);
+        scan.printAll();
+        indexed.printAll();
+        EXPECT_EQ(scanOutput.str(), indexOutput.str()) << step.condition;
+        EXPECT_EQ(indexed.getIndexPlanCount(), step.indexPlans) << step.condition;
+        EXPECT_EQ(indexed.getScanPlanCount(), step.scanPlans) << step.condition;
+    }
+    EXPECT_EQ(statistics->getTypeCount(FilmType::Series), indexed.size());
+
+    indexed.setDirectorIndex(false);
+    indexed.setEpisodeIndex(false);
+    EXPECT_EQ(indexed.getStatistics(), nullptr);
+}
+
+TEST(FilmContainerTest, FindAndCountLeaveFilms) {
+    BufferOutputSink scanOutput;
+    BufferOutputSink indexOutput;
+    FilmContainer scan(scanOutput);
+    FilmContainer indexed(indexOutput);
+    indexed.setTitleIndex(true);
+    indexed.setDirectorIndex(true);
+    indexed.setEpisodeIndex(true);
+    for (FilmContainer* container : { &scan, &indexed }) {
+        for (int i = 0; i < 60; ++i) {
+            container->addFilm(std::make_unique<SeriesFilm>("Film" + std::to_string(i % 20), "Director" + std::to_string(i % 3), i + 1));
+            if (i % 10 == 0) {
+                container->addFilm(std::make_unique<GameFilm>("Film" + std::to_string(i % 20), "Director1"));
+            }
+        }
+    }
+
+    const char* conditions[] = {
+        "title == Film5", "director == Director1", "episodes < 4", "episodes > 2",
+        "title == Film5 OR director == Director2", "director == Director1 AND NOT type == series", "title == Missing",
+    };
+    for (const char* condition : conditions) {
+        for (size_t limit : { size_t(1), size_t(3), SIZE_MAX }) {
+            scanOutput.clear();
+            indexOutput.clear();
+            EXPECT_EQ(scan.findFilms(condition, limit), indexed.findFilms(condition, limit)) << condition;
+            EXPECT_EQ(scanOutput.str(), indexOutput.str()) << condition << " LIMIT " << limit;
+        }
+        size_t counted = scan.countFilms(condition);
+        EXPECT_EQ(counted, indexed.countFilms(condition)) << condition;
+        EXPECT_EQ(counted, scan.findFilms(condition)) << condition;
+    }
+    EXPECT_EQ(scan.size(), 66u);
+    EXPECT_EQ(indexed.size(), 66u);
+
+    // Совпадения выводятся в порядке добавления, LIMIT обрывает вывод
+    scanOutput.clear();
+    scan.findFilms("title == Film1 OR title == Film0", 3);
+    EXPECT_EQ(scanOutput.str(), "1. Series film: Film0, director: Director0, episodes: 1\n"
+        "2. Game film: Film0, director: Director1\n"
+        "3. Series film: Film1, director: Director1, episodes: 2\n"
+        "Found 3 film(s)\n");
+
+    scanOutput.clear();
+    scan.countFilms("id > 3");
+    EXPECT_EQ(scanOutput.str(), "Error counting films: id condition must have the form 'id == N' or 'id != N'\n");
+}
+
+// Ресурс памяти, считающий выделения и освобождения
+class CountingResource : public std::pmr::memory_resource
+{
+public:
+    size_t allocations = 0;
+    size_t deallocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        ++deallocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+TEST(FilmContainerTest, FilmsLiveInMemoryResource) {
+    CountingResource resource;
+    {
+        BufferOutputSink buffer;
+        FilmContainer container(buffer, &resource);
+        container.addFilm(FilmValue(GameFilm("Inception", "Nolan")));
+        std::vector<FilmValue> batch;
+        batch.push_back(CartoonFilm("Shrek", TypeCreation::Drawn));
+        batch.push_back(SeriesFilm("Lost", "Abrams", 121));
+        container.addFilms(std::move(batch));
+        // Фильмы, созданные через new, контейнер принимает как есть
+        container.addFilm(std::make_unique<GameFilm>("Tenet", "Nolan"));
+        EXPECT_EQ(resource.allocations, 3);
+
+        container.removeFilms("title == Shrek");
+        EXPECT_EQ(resource.deallocations, 1);
+        container.printAll();
+        EXPECT_EQ(buffer.str(), "Film added successfully\n"
+            "Added 2 film(s) successfully\n"
+            "Film added successfully\n"
+            "Successfully removed 1 film(s)\n"
+            "Films in container (3 total):\n"
+            "1. Game film: Inception, director: Nolan\n"
+            "2. Series film: Lost, director: Abrams, episodes: 121\n"
+            "3. Game film: Tenet, director: Nolan\n");
+
+        // Фильмы из снимка размещаются в том же ресурсе, включая созданный через new
+        const std::string filename = "test_resource_snapshot.bin";
+        ASSERT_TRUE(container.saveSnapshot(filename));
+        ASSERT_TRUE(container.loadSnapshot(filename));
+        std::remove(filename.c_str());
+        EXPECT_EQ(resource.allocations, 6);
+        EXPECT_EQ(resource.deallocations, 3);
+        EXPECT_EQ(container.size(), 3);
+    }
+    EXPECT_EQ(resource.deallocations, 6);
+}
+
+TEST(FilmContainerTest, ParallelRemovalMatchesSequential) {
+    BufferOutputSink sequentialOutput;
+    BufferOutputSink parallelOutput;
+    FilmContainer sequential(sequentialOutput);
+    FilmContainer parallel(parallelOutput);
+    // Порог в один фильм отправляет в потоки каждый просмотр
+    parallel.setRemovalThreads(4);
+    parallel.setParallelRemovalThreshold(1);
+    EXPECT_EQ(parallel.getRemovalThreads(), 4u);
+    EXPECT_EQ(sequential.getRemovalThreads(), 1u);
+    parallel.setCompactionThreshold(0.5);
+    sequential.setCompactionThreshold(0.5);
+
+    for (FilmContainer* container : { &sequential, &parallel }) {
+        for (int i = 0; i < 3000; ++i) {
+            std::string title = "Film" + std::to_string(i % 97);
+            container->addFilm(std::make_unique<SeriesFilm>(title, "Director" + std::to_string(i % 13), i % 200 + 1));
+            if (i % 3 == 0) {
+                container->addFilm(std::make_unique<GameFilm>(title, "Nolan"));
+            }
+            if (i % 5 == 0) {
+                container->addFilm(std::make_unique<CartoonFilm>(title, i % 2 ? TypeCreation::Doll : TypeCreation::Drawn));
+            }
+        }
+    }
+
+    const char* conditions[] = {
+        "title == Film3", "director != Director4", "animation_type == doll",
+        "title == Film5 OR episodes < 20", "NOT director == Nolan AND title != Film7", "id != 17",
+        "title >= Film9",
+    };
+    for (const char* condition : conditions) {
+        sequential.removeFilms(condition);
+        parallel.removeFilms(condition);
+        // Идентификаторы тоже должны совпасть: ячейки освобождаются в том же порядке
+        sequential.printAll(true);
+        parallel.printAll(true);
+        EXPECT_EQ(sequentialOutput.str(), parallelOutput.str()) << condition;
+        EXPECT_EQ(sequential.size(), parallel.size()) << condition;
+    }
+    EXPECT_EQ(sequential.addFilm(std::make_unique<GameFilm>("Late", "Nolan")),
+        parallel.addFilm(std::make_unique<GameFilm>("Late", "Nolan")));
 }
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include "FilmContainer.h"
+#include "FilmJournal.h"
+#include "GameFilm.h"
+#include "CartoonFilm.h"
+#include "SeriesFilm.h"
+#include "Commands.h"
+
+static std::vector<std::string> readLines(const std::string& filename) {
+    std::ifstream input(filename);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(input, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+TEST(JournalTest, FormatAddCommand) {
+    EXPECT_EQ(formatAddCommand(GameFilm("Matrix", "Wachowski")), "ADD game \"Matrix\"|Wachowski");
+    EXPECT_EQ(formatAddCommand(CartoonFilm(" Shrek ", TypeCreation::Doll)), "ADD cartoon \" Shrek \"|puppet");
+    EXPECT_EQ(formatAddCommand(SeriesFilm("Lost", "Abrams", 121)), "ADD series \"Lost\"|Abrams|121");
+
+    // Строка журнала разбирается обратно в тот же фильм
+    AddRecord record;
+    std::string error;
+    std::string line = formatAddCommand(CartoonFilm("\"Quoted\"", TypeCreation::Plasticine));
+    ASSERT_TRUE(parseAddCommand(std::string_view(line).substr(4), record, error));
+    EXPECT_EQ(record.title, "\"Quoted\"");
+    EXPECT_EQ(record.creation, TypeCreation::Plasticine);
+}
+
+TEST(JournalTest, AppendsAndCompacts) {
+    const std::string filename = "test_journal.txt";
+    std::remove(filename.c_str());
+    NullOutputSink null;
+    FilmContainer container(null);
+    container.addFilm(std::make_unique<GameFilm>("Matrix", "Wachowski"));
+    ASSERT_TRUE(container.attachJournal(filename));
+
+    container.addFilm(std::make_unique<SeriesFilm>("Lost", "Abrams", 121));
+    container.addFilm(std::make_unique<CartoonFilm>("Shrek", TypeCreation::Drawn));
+    container.removeFilms("title == Shrek");
+    container.removeFilms("title == Missing");
+
+    std::vector<std::string> expected = {
+        "ADD game \"Matrix\"|Wachowski",
+        "ADD series \"Lost\"|Abrams|121",
+        "ADD cartoon \"Shrek\"|drawn",
+        "REM title == Shrek",
+    };
+    EXPECT_EQ(readLines(filename), expected);
+
+    ASSERT_TRUE(container.compactJournal());
+    expected = { "ADD game \"Matrix\"|Wachowski", "ADD series \"Lost\"|Abrams|121" };
+    EXPECT_EQ(readLines(filename), expected);
+
+    container.detachJournal();
+    std::remove(filename.c_str());
+}
+
+TEST(JournalTest, CommitsEachMutation) {
+    const std::string filename = "test_journal_commit.txt";
+    std::remove(filename.c_str());
+    NullOutputSink null;
+    FilmContainer container(null);
+    ASSERT_TRUE(container.attachJournal(filename));
+
+    // Без групповой записи ADD попадает в файл сразу, не дожидаясь REM или отключения журнала
+    container.addFilm(std::make_unique<GameFilm>("Matrix", "Wachowski"));
+    EXPECT_EQ(readLines(filename).size(), 1u);
+
+    // В группе из трех изменений файл дописывается на каждом третьем
+    container.setJournalGroupCommit(3);
+    container.addFilm(std::make_unique<GameFilm>("Tenet", "Nolan"));
+    container.addFilm(std::make_unique<GameFilm>("Dune", "Villeneuve"));
+    EXPECT_EQ(readLines(filename).size(), 1u);
+    container.removeFilms("title == Dune");
+    EXPECT_EQ(readLines(filename).size(), 4u);
+
+    container.detachJournal();
+    std::remove(filename.c_str());
+}
+
+TEST(JournalTest, FailedCompactionKeepsJournal) {
+    const std::string filename = "test_journal_failed.txt";
+    std::remove(filename.c_str());
+    BufferOutputSink output;
+    FilmContainer container(output);
+    ASSERT_TRUE(container.attachJournal(filename));
+    container.addFilm(std::make_unique<GameFilm>("Matrix", "Wachowski"));
+    container.addFilm(std::make_unique<GameFilm>("Tenet", "Nolan"));
+    container.removeFilms("title == Tenet");
+
+    // Временный файл занят каталогом: прежний журнал остается и продолжает дописываться
+    std::filesystem::create_directory(filename + ".tmp");
+    output.clear();
+    EXPECT_FALSE(container.compactJournal());
+    EXPECT_EQ(output.str(), "Error: Cannot create journal file '" + filename + ".tmp'\n");
+    container.addFilm(std::make_unique<GameFilm>("Dune", "Villeneuve"));
+    std::filesystem::remove(filename + ".tmp");
+
+    std::vector<std::string> expected = {
+        "ADD game \"Matrix\"|Wachowski",
+        "ADD game \"Tenet\"|Nolan",
+        "REM title == Tenet",
+        "ADD game \"Dune\"|Villeneuve",
+    };
+    EXPECT_EQ(readLines(filename), expected);
+
+    container.detachJournal();
+    std::remove(filename.c_str());
+}
+
+TEST(JournalTest, ReplayRestoresState) {
+    const std::string journalFile = "test_journal_replay.txt";
+    const std::string commandsFile = "test_journal_commands.txt";
+    std::remove(journalFile.c_str());
+    std::ofstream testFile(commandsFile);
+    testFile << "JOURNAL " << journalFile << "\n";
+    for (int i = 0; i < 50; ++i) {
+        testFile << "ADD series Show" << i << "|Director|" << i + 1 << "\n";
+    }
+    testFile << "REM episodes > 10\n";
+    testFile << "COMPACT\n";
+    testFile.close();
+
+    BufferOutputSink first;
+    FilmContainer original(first);
+    commandFromFile(commandsFile, original);
+    EXPECT_EQ(original.size(), 10);
+    EXPECT_TRUE(first.str().find("Journal compacted: 51 -> 10 record(s)") != std::string::npos);
+    original.detachJournal();
+    EXPECT_EQ(readLines(journalFile).size(), 10);
+
+    // Повторный запуск: журнал воспроизводится, затем к нему снова подключаемся
+    std::ofstream restart(commandsFile);
+    restart << "JOURNAL " << journalFile << "\nPRINT\n";
+    restart.close();
+    BufferOutputSink second;
+    FilmContainer restored(second);
+    commandFromFile(commandsFile, restored);
+    EXPECT_EQ(restored.size(), 10);
+    EXPECT_TRUE(second.str().find("Journal replayed: 10 film(s)") != std::string::npos);
+    EXPECT_TRUE(second.str().find("10. Series film: Show9, director: Director, episodes: 10") != std::string::npos);
+    restored.detachJournal();
+
+    std::remove(journalFile.c_str());
+    std::remove(commandsFile.c_str());
+}
+
+TEST(JournalTest, RemovalByIdAppendsDeleteRecords) {
+    const std::string journalFile = "test_journal_ids.txt";
+    const std::string commandsFile = "test_journal_ids_commands.txt";
+    std::remove(journalFile.c_str());
+    BufferOutputSink first;
+    FilmContainer original(first);
+    original.addFilm(std::make_unique<GameFilm>("Old", "Director"));
+    FilmId removedBefore = original.addFilm(std::make_unique<GameFilm>("Gone", "Director"));
+    original.removeFilm(removedBefore);
+    ASSERT_TRUE(original.attachJournal(journalFile));
+    FilmId matrix = original.addFilm(std::make_unique<GameFilm>("Matrix", "Wachowski"));
+    original.addFilm(std::make_unique<SeriesFilm>("Lost", "Abrams", 121));
+    FilmId shrek = original.addFilm(std::make_unique<CartoonFilm>("Shrek", TypeCreation::Drawn));
+
+    // Удаление по id дописывает DEL с номером записи ADD, журнал не переписывается
+    first.clear();
+    EXPECT_TRUE(original.removeFilm(shrek));
+    original.removeFilms("id == " + std::to_string(matrix));
+    EXPECT_FALSE(original.removeFilm(matrix));
+    EXPECT_EQ(first.str(), "Successfully removed 1 film(s)\n"
+        "Successfully removed 1 film(s)\n"
+        "Error: No film with id " + std::to_string(matrix) + "\n");
+    std::vector<std::string> expected = {
+        "ADD game \"Old\"|Director",
+        "ADD game \"Matrix\"|Wachowski",
+        "ADD series \"Lost\"|Abrams|121",
+        "ADD cartoon \"Shrek\"|drawn",
+        "DEL 3",
+        "DEL 1",
+    };
+    EXPECT_EQ(readLines(journalFile), expected);
+    original.detachJournal();
+
+    // Номера DEL отсчитываются от начала воспроизведения, даже если в контейнере уже есть фильмы
+    std::ofstream restart(commandsFile);
+    restart << "ADD game Existing|Director\nJOURNAL " << journalFile << "\nDEL 0\nPRINT\n";
+    restart.close();
+    BufferOutputSink second;
+    FilmContainer restored(second);
+    commandFromFile(commandsFile, restored);
+    EXPECT_EQ(second.str(), "Film added successfully\n"
+        "Journal replayed: 2 film(s) from '" + journalFile + "'\n"
+        "Journal attached: '" + journalFile + "' (3 film(s))\n"
+        "Error: Unknown command 'DEL' at line 3\n"
+        "Films in container (3 total):\n"
+        "1. Game film: Existing, director: Director\n"
+        "2. Game film: Old, director: Director\n"
+        "3. Series film: Lost, director: Abrams, episodes: 121\n"
+        "Finished processing file. Total films in container: 3\n");
+    restored.detachJournal();
+
+    std::remove(journalFile.c_str());
+    std::remove(commandsFile.c_str());
+}
@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include "NumberFilter.h"
+#include "StringSearch.h"
+#include "FilmContainer.h"
+#include "GameFilm.h"
+#include "SeriesFilm.h"
+#include <climits>
+#include <random>
+
+static bool compareDirect(int value, ConditionOp op, int bound) {
+    switch (op) {
+    case ConditionOp::Equal: return value == bound;
+    case ConditionOp::NotEqual: return value != bound;
+    case ConditionOp::Greater: return value > bound;
+    case ConditionOp::Less: return value < bound;
+    case ConditionOp::GreaterEqual: return value >= bound;
+    case ConditionOp::LessEqual: return value <= bound;
+    default: return false;
+    }
+}
+
+TEST(NumberFilterTest, KernelsMatchDirectComparison) {
+    SimdKernel saved = activeFilterKernel();
+    const ConditionOp ops[] = { ConditionOp::Equal, ConditionOp::NotEqual, ConditionOp::Greater, ConditionOp::Less,
+        ConditionOp::GreaterEqual, ConditionOp::LessEqual };
+    std::mt19937 random(11);
+    std::vector<uint64_t> bitmap;
+    for (SimdKernel kernel : { SimdKernel::Scalar, SimdKernel::Sse2, SimdKernel::Avx2 }) {
+        setFilterKernel(kernel);
+        // Длины вокруг границ слова карты и векторного шага
+        for (size_t count : { 0, 1, 7, 63, 64, 65, 130, 200 }) {
+            std::vector<int> values(count);
+            for (int& value : values) {
+                value = static_cast<int>(random() % 21) - 10;
+            }
+            if (count > 2) {
+                values[0] = INT_MIN;
+                values[1] = INT_MAX;
+            }
+            for (ConditionOp op : ops) {
+                for (int bound : { -10, 0, 3, INT_MAX }) {
+                    ASSERT_TRUE(selectNumbers(values.data(), values.size(), op, bound, bitmap));
+                    ASSERT_EQ(bitmap.size(), (count + 63) / 64);
+                    size_t expected = 0;
+                    for (size_t i = 0; i < count; ++i) {
+                        bool selected = (bitmap[i / 64] >> (i % 64)) & 1;
+                        EXPECT_EQ(selected, compareDirect(values[i], op, bound))
+                            << simdKernelName(kernel) << " value " << values[i] << " bound " << bound;
+                        expected += selected;
+                    }
+                    EXPECT_EQ(countSelected(bitmap), expected) << simdKernelName(kernel);
+                }
+            }
+        }
+    }
+    EXPECT_FALSE(selectNumbers(nullptr, 0, ConditionOp::Contains, 1, bitmap));
+    setFilterKernel(saved);
+
+    // Ядра отбора чисел и поиска строк переключаются независимо
+    SimdKernel search = activeSearchKernel();
+    setFilterKernel(SimdKernel::Scalar);
+    EXPECT_EQ(activeFilterKernel(), SimdKernel::Scalar);
+    EXPECT_EQ(activeSearchKernel(), search);
+    setFilterKernel(saved);
+}
+
+TEST(NumberFilterTest, EpisodeRemovalSkipsTombstones) {
+    BufferOutputSink buffer;
+    FilmContainer container(buffer);
+    // Удаленные сериалы остаются в столбце episodes до уплотнения и не должны считаться повторно
+    container.setCompactionThreshold(1.0);
+    for (int i = 1; i <= 100; ++i) {
+        container.addFilm(std::make_unique<SeriesFilm>("Series " + std::to_string(i), "Director", i));
+        container.addFilm(std::make_unique<GameFilm>("Game " + std::to_string(i), "Director"));
+    }
+    buffer.clear();
+
+    container.removeFilms("episodes > 90");
+    container.removeFilms("episodes >= 85");
+    container.removeFilms("episodes contains 5");
+    container.removeFilms("episodes > many");
+    container.removeFilms("episodes != 3");
+    EXPECT_EQ(buffer.str(), "Successfully removed 10 film(s)\n"
+        "Successfully removed 6 film(s)\n"
+        "Successfully removed 0 film(s)\n"
+        "Successfully removed 0 film(s)\n"
+        "Successfully removed 83 film(s)\n");
+    EXPECT_EQ(container.size(), 101u);
+
+    buffer.clear();
+    container.findFilms("type == series");
+    EXPECT_EQ(buffer.str(), "1. Series film: Series 3, director: Director, episodes: 3\nFound 1 film(s)\n");
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include "FilmContainer.h"
+#include "FilmSnapshot.h"
+#include "GameFilm.h"
+#include "CartoonFilm.h"
+#include "SeriesFilm.h"
+#include "Commands.h"
+
+static void fillContainer(FilmContainer& container) {
+    container.addFilm(std::make_unique<GameFilm>("Matrix", "Wachowski"));
+    container.addFilm(std::make_unique<CartoonFilm>("Shrek", TypeCreation::Doll));
+    container.addFilm(std::make_unique<SeriesFilm>("Friends", "David Crane", 236));
+    container.addFilm(std::make_unique<CartoonFilm>("Wallace", TypeCreation::Plasticine));
+}
+
+TEST(SnapshotTest, SaveAndLoad) {
+    const std::string filename = "test_snapshot.bin";
+    BufferOutputSink original;
+    FilmContainer source(original);
+    fillContainer(source);
+    EXPECT_TRUE(source.saveSnapshot(filename));
+    EXPECT_TRUE(original.str().find("Snapshot saved: 4 film(s)") != std::string::npos);
+
+    BufferOutputSink restored;
+    FilmContainer target(restored);
+    target.addFilm(std::make_unique<GameFilm>("Old", "Director"));
+    EXPECT_TRUE(target.loadSnapshot(filename));
+    EXPECT_EQ(target.size(), 4);
+
+    // Содержимое после загрузки печатается так же, как у исходного контейнера
+    original.clear();
+    restored.clear();
+    source.printAll();
+    target.printAll();
+    EXPECT_EQ(original.str(), restored.str());
+
+    std::remove(filename.c_str());
+}
+
+TEST(SnapshotTest, IdsFromBeforeLoadMatchNothing) {
+    const std::string filename = "test_snapshot_ids.bin";
+    BufferOutputSink output;
+    FilmContainer container(output);
+    std::vector<FilmId> ids;
+    ids.push_back(container.addFilm(std::make_unique<GameFilm>("Matrix", "Wachowski")));
+    ids.push_back(container.addFilm(std::make_unique<CartoonFilm>("Shrek", TypeCreation::Doll)));
+    ids.push_back(container.addFilm(std::make_unique<SeriesFilm>("Friends", "David Crane", 236)));
+    ASSERT_TRUE(container.saveSnapshot(filename));
+    ASSERT_TRUE(container.loadSnapshot(filename));
+    ASSERT_EQ(container.size(), 3);
+
+    // Загруженные фильмы заняли те же ячейки, но с новым поколением
+    for (FilmId id : ids) {
+        output.clear();
+        container.removeFilms("id == " + std::to_string(id));
+        EXPECT_EQ(output.str(), "Successfully removed 0 film(s)\n") << id;
+        EXPECT_FALSE(container.removeFilm(id));
+    }
+    EXPECT_EQ(container.size(), 3);
+
+    std::remove(filename.c_str());
+}
+
+TEST(SnapshotTest, FailedSaveKeepsPreviousSnapshot) {
+    const std::string filename = "test_snapshot_keep.bin";
+    BufferOutputSink output;
+    FilmContainer source(output);
+    fillContainer(source);
+    ASSERT_TRUE(source.saveSnapshot(filename));
+
+    // Временный файл занят каталогом, поэтому следующий SAVE не может начаться
+    std::filesystem::create_directory(filename + ".tmp");
+    source.addFilm(std::make_unique<GameFilm>("Extra", "Director"));
+    EXPECT_FALSE(source.saveSnapshot(filename));
+    std::filesystem::remove(filename + ".tmp");
+
+    FilmContainer target(output);
+    EXPECT_TRUE(target.loadSnapshot(filename));
+    EXPECT_EQ(target.size(), 4);
+    EXPECT_FALSE(std::filesystem::exists(filename + ".tmp"));
+
+    std::remove(filename.c_str());
+}
+
+TEST(SnapshotTest, FailedReplaceKeepsTarget) {
+    // Пустой каталог на месте снимка нельзя заменить файлом; раньше его удаляли перед повторной попыткой
+    const std::string filename = "test_snapshot_target";
+    std::filesystem::create_directory(filename);
+    BufferOutputSink output;
+    FilmContainer source(output);
+    fillContainer(source);
+    output.clear();
+    EXPECT_FALSE(source.saveSnapshot(filename));
+    EXPECT_EQ(output.str(), "Error: Cannot replace snapshot file '" + filename + "'\n");
+    EXPECT_TRUE(std::filesystem::is_directory(filename));
+    EXPECT_FALSE(std::filesystem::exists(filename + ".tmp"));
+
+    std::filesystem::remove(filename);
+}
+
+TEST(SnapshotTest, RejectsCorruptedFiles) {
+    const std::string filename = "test_snapshot_bad.bin";
+    NullOutputSink null;
+    FilmContainer source(null);
+    fillContainer(source);
+    ASSERT_TRUE(source.saveSnapshot(filename));
+
+    std::ifstream input(filename, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    input.close();
+
+    std::vector<FilmValue> films;
+    std::string error;
+
+    std::string flipped = bytes;
+    flipped[30] ^= 0x5A;
+    std::ofstream(filename, std::ios::binary) << flipped;
+    EXPECT_FALSE(readFilmSnapshot(filename, films, error));
+    EXPECT_TRUE(error.find("checksum mismatch") != std::string::npos);
+
+    std::ofstream(filename, std::ios::binary) << bytes.substr(0, 12);
+    EXPECT_FALSE(readFilmSnapshot(filename, films, error));
+    EXPECT_TRUE(error.find("is not a film snapshot") != std::string::npos);
+
+    std::ofstream(filename, std::ios::binary) << "ADD game Matrix|Wachowski\n";
+    EXPECT_FALSE(readFilmSnapshot(filename, films, error));
+    EXPECT_TRUE(films.empty());
+
+    EXPECT_FALSE(readFilmSnapshot("non_existent_snapshot.bin", films, error));
+    EXPECT_TRUE(error.find("Cannot open snapshot file") != std::string::npos);
+
+    std::remove(filename.c_str());
+}
+
+TEST(SnapshotTest, SaveAndLoadCommands) {
+    const std::string commandsFile = "test_snapshot_commands.txt";
+    std::ofstream testFile(commandsFile);
+    testFile << "ADD game Matrix|Wachowski\n";
+    testFile << "ADD series Lost|Abrams|121\n";
+    testFile << "SAVE  test_snapshot_cmd.bin \n";
+    testFile << "REM type == game\n";
+    testFile << "LOAD test_snapshot_cmd.bin\n";
+    testFile << "LOAD\n";
+    testFile.close();
+
+    BufferOutputSink output;
+    FilmContainer container(output);
+    commandFromFile(commandsFile, container);
+    EXPECT_EQ(container.size(), 2);
+    EXPECT_TRUE(output.str().find("Snapshot saved: 2 film(s) to 'test_snapshot_cmd.bin'") != std::string::npos);
+    EXPECT_TRUE(output.str().find("Snapshot loaded: 2 film(s) from 'test_snapshot_cmd.bin'") != std::string::npos);
+    EXPECT_TRUE(output.str().find("Error: Missing filename for LOAD command") != std::string::npos);
+
+    std::remove(commandsFile.c_str());
+    std::remove("test_snapshot_cmd.bin");
+}
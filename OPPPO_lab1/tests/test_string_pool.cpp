@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "StringPool.h"
+#include "Condition.h"
+#include "GameFilm.h"
+#include "SeriesFilm.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(StringPoolTest, InternSharesOneCopy) {
+    StringPoolStats before = StringPool::shared().getStats();
+    {
+        InternedString first("Pool test director");
+        InternedString second(std::string("Pool test director"));
+        InternedString other("Pool test other");
+        EXPECT_EQ(first, second);
+        EXPECT_NE(first, other);
+        EXPECT_EQ(&first.str(), &second.str());
+
+        StringPoolStats during = StringPool::shared().getStats();
+        EXPECT_EQ(during.distinctStrings, before.distinctStrings + 2);
+        EXPECT_EQ(during.references, before.references + 3);
+        EXPECT_EQ(during.sharedBytes(), before.sharedBytes() + std::string("Pool test director").size());
+        // Каждое новое значение стоит записи и узла таблицы
+        EXPECT_GT(during.overheadBytes, before.overheadBytes);
+        EXPECT_EQ(during.savedBytes(), before.savedBytes() + static_cast<int64_t>(std::string("Pool test director").size())
+            - static_cast<int64_t>(during.overheadBytes - before.overheadBytes));
+    }
+
+    // Строка уходит из пула вместе с последней ссылкой
+    StringPoolStats after = StringPool::shared().getStats();
+    EXPECT_EQ(after.distinctStrings, before.distinctStrings);
+    EXPECT_EQ(after.storedBytes, before.storedBytes);
+    EXPECT_EQ(after.overheadBytes, before.overheadBytes);
+    EXPECT_TRUE(StringPool::shared().find("Pool test director").empty());
+}
+
+TEST(StringPoolTest, FilmsShareDirectors) {
+    GameFilm game("Pool game", "Pool Nolan");
+    SeriesFilm series("Pool series", "Pool Nolan", 10);
+    EXPECT_EQ(&game.getDirector(), &series.getDirector());
+
+    EXPECT_TRUE(game.matches(Condition::compile("director == Pool Nolan")));
+    EXPECT_FALSE(series.matches(Condition::compile("director != Pool Nolan")));
+    EXPECT_TRUE(series.matches(Condition::compile("title != Pool game")));
+    EXPECT_TRUE(series.matches(Condition::compile("director contains Nol")));
+}
+
+TEST(StringPoolTest, ConditionCompiledBeforeFilm) {
+    // Значения еще нет в пуле при компиляции условия
+    Condition equal = Condition::compile("title == Pool late title");
+    Condition notEqual = Condition::compile("title != Pool late title");
+    GameFilm film("Pool late title", "Pool director");
+    EXPECT_TRUE(film.matches(equal));
+    EXPECT_FALSE(film.matches(notEqual));
+}
+
+TEST(StringPoolTest, ConcurrentInterning) {
+    StringPoolStats before = StringPool::shared().getStats();
+    {
+        std::vector<std::vector<InternedString>> interned(4);
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < interned.size(); ++t) {
+            threads.emplace_back([&interned, t]() {
+                for (int i = 0; i < 1000; ++i) {
+                    interned[t].emplace_back("Pool thread " + std::to_string(i % 100));
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        // Все потоки получили одни и те же строки
+        EXPECT_EQ(&interned[0][5].str(), &interned[3][5].str());
+
+        StringPoolStats during = StringPool::shared().getStats();
+        EXPECT_EQ(during.distinctStrings, before.distinctStrings + 100);
+        EXPECT_EQ(during.references, before.references + 4000);
+        EXPECT_GE(during.lockAcquisitions, before.lockAcquisitions + 4000);
+        EXPECT_LE(during.contendedLocks, during.lockAcquisitions);
+    }
+    EXPECT_EQ(StringPool::shared().getStats().distinctStrings, before.distinctStrings);
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "StringSearch.h"
+#include "FilmContainer.h"
+#include "GameFilm.h"
+#include "SeriesFilm.h"
+#include <random>
+
+static const SimdKernel KERNELS[] = { SimdKernel::Scalar, SimdKernel::Sse2, SimdKernel::Avx2 };
+
+// Возвращает исходное ядро после теста
+class SearchKernelGuard
+{
+private:
+    SimdKernel saved = activeSearchKernel();
+
+public:
+    ~SearchKernelGuard() {
+        setSearchKernel(saved);
+    }
+};
+
+TEST(StringSearchTest, KernelsMatchStdFind) {
+    SearchKernelGuard guard;
+    std::mt19937 random(7);
+    // Маленький алфавит дает много частичных совпадений по первому и последнему байту
+    auto randomText = [&random](size_t length) {
+        std::string text(length, 'a');
+        for (char& c : text) {
+            c = static_cast<char>('a' + random() % 3);
+        }
+        return text;
+    };
+
+    for (SimdKernel kernel : KERNELS) {
+        if (!isSimdKernelSupported(kernel)) {
+            continue;
+        }
+        setSearchKernel(kernel);
+        EXPECT_EQ(activeSearchKernel(), kernel);
+        for (int round = 0; round < 2000; ++round) {
+            std::string text = randomText(random() % 100);
+            std::string needle = randomText(random() % 6);
+            EXPECT_EQ(containsBytes(text, needle), text.find(needle) != std::string::npos)
+                << simdKernelName(kernel) << " '" << text << "' '" << needle << "'";
+            std::string copy = text;
+            if (!copy.empty() && round % 2 == 0) {
+                copy[random() % copy.size()] ^= 1;
+            }
+            EXPECT_EQ(equalBytes(text, copy), text == copy) << simdKernelName(kernel);
+        }
+
+        // Совпадение в последней позиции, которую векторный шаг оставляет хвосту
+        std::string text(70, 'x');
+        text.replace(64, 6, "needle");
+        EXPECT_TRUE(containsBytes(text, "needle")) << simdKernelName(kernel);
+        EXPECT_FALSE(containsBytes(text, "needles")) << simdKernelName(kernel);
+    }
+}
+
+TEST(StringSearchTest, BatchMatchesEachString) {
+    SearchKernelGuard guard;
+    std::vector<std::string> texts = { "Star Wars", "", "Wars", "Star Trek", "Trek Wars Star", "W", "ars" };
+    for (int i = 0; i < 100; ++i) {
+        texts.push_back("Film" + std::to_string(i * 37));
+    }
+    BatchSearch batch;
+    for (const std::string& text : texts) {
+        batch.add(text);
+    }
+    ASSERT_EQ(batch.size(), texts.size());
+
+    const std::string needles[] = { "Wars", "ar", "Star", "s", "", "Film1", "74", "Nothing", std::string("a\0b", 3) };
+    std::vector<unsigned char> hits;
+    for (SimdKernel kernel : KERNELS) {
+        setSearchKernel(kernel);
+        for (const std::string& needle : needles) {
+            batch.containsEach(needle, hits);
+            ASSERT_EQ(hits.size(), texts.size());
+            for (size_t i = 0; i < texts.size(); ++i) {
+                EXPECT_EQ(hits[i] != 0, texts[i].find(needle) != std::string::npos)
+                    << simdKernelName(kernel) << " '" << texts[i] << "' '" << needle << "'";
+            }
+        }
+    }
+}
+
+TEST(StringSearchTest, ContainsRemovalMatchesScalar) {
+    SearchKernelGuard guard;
+    const SimdKernel passes[] = { SimdKernel::Scalar, activeSearchKernel() };
+    std::string outputs[2];
+    for (int pass = 0; pass < 2; ++pass) {
+        setSearchKernel(passes[pass]);
+        BufferOutputSink buffer;
+        FilmContainer container(buffer);
+        for (int i = 0; i < 300; ++i) {
+            container.addFilm(std::make_unique<SeriesFilm>("Episode title number " + std::to_string(i), "Director " + std::to_string(i % 7), i + 1));
+            container.addFilm(std::make_unique<GameFilm>("Game " + std::to_string(i), "Director " + std::to_string(i % 5)));
+        }
+        container.removeFilms("title contains number 1");
+        container.removeFilms("director contains r 3");
+        container.removeFilms("title contains 9");
+        container.printAll();
+        outputs[pass] = buffer.str();
+    }
+    EXPECT_EQ(outputs[0], outputs[1]);
+}
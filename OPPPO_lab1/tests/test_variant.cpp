@@ -0,0 +1,13 @@
+#include <gtest/gtest.h>
+#include <type_traits>
+#include "FilmValue.h"
+#include "Commands.h"
+
+TEST(FilmValueTest, MovableWithoutCopy) {
+    static_assert(std::is_nothrow_move_constructible_v<FilmValue>, "FilmValue must move without copying strings");
+
+    FilmValue film = SeriesFilm("Friends", "Crane", 236);
+    EXPECT_EQ(asFilm(film).getTitle(), "Friends");
+    EXPECT_EQ(asFilm(film).getTypeTag(), FilmType::Series);
+    EXPECT_TRUE(asFilm(film).matches(Condition::compile("episodes > 200")));
+}